@@ -0,0 +1,200 @@
+#include "lib/anytime_search.h"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+namespace scout
+{
+
+    namespace
+    {
+        // How much faster than the fastest check interval so far the rest of the search
+        // is assumed to run at most, when bounding the simulations left before a deadline.
+        constexpr double DEADLINE_RATE_MARGIN = 2.0;
+    }
+
+    AnytimeSearch::AnytimeSearch(ExpansionStrategy strategy, Evaluator evaluator)
+        : mcts_(std::move(strategy), std::move(evaluator)) {}
+
+    SearchResult AnytimeSearch::search(const GameState &state, const SearchLimits &limits)
+    {
+        TreeNode root(std::make_unique<GameState>(state), GameState::NUM_MOVES);
+        return search(root, limits);
+    }
+
+    SearchResult AnytimeSearch::search(TreeNode &root, const SearchLimits &limits)
+    {
+        if (root.state().isGameOver())
+        {
+            throw std::invalid_argument("Cannot search a finished game.");
+        }
+        if (limits.checkInterval <= 0)
+        {
+            throw std::invalid_argument("The check interval must be positive.");
+        }
+
+        using Clock = std::chrono::steady_clock;
+        const Clock::time_point start = Clock::now();
+        const Clock::time_point deadline =
+            limits.deadline.has_value() ? start + *limits.deadline : Clock::time_point::max();
+
+        // Moves pruned by an earlier search may be back in contention.
+        root.clearExcludedMoves();
+        mcts_.resetStats();
+
+        SearchResult result;
+        Clock::time_point last_check = start;
+        int last_check_simulations = 0;
+        double fastest_rate = 0.0;
+        while (true)
+        {
+            if (root.isProven())
+            {
+                result.stopReason = StopReason::PROVEN;
+                break;
+            }
+            if (limits.maxSimulations.has_value() && result.simulations >= *limits.maxSimulations &&
+                result.simulations > 0)
+            {
+                result.stopReason = StopReason::SIMULATIONS;
+                break;
+            }
+            // Reading the clock costs more than a cheap simulation, so only do it now and then.
+            if (result.simulations > 0 && result.simulations % limits.checkInterval == 0)
+            {
+                if (cancelled_.exchange(false))
+                {
+                    result.stopReason = StopReason::CANCELLED;
+                    break;
+                }
+                int capped = std::numeric_limits<int>::max();
+                if (limits.maxSimulations.has_value())
+                {
+                    capped = *limits.maxSimulations - result.simulations;
+                }
+                int remaining = capped;
+                if (limits.deadline.has_value())
+                {
+                    const Clock::time_point now = Clock::now();
+                    if (now >= deadline)
+                    {
+                        result.stopReason = StopReason::DEADLINE;
+                        break;
+                    }
+                    // The average rate so far is no bound: simulations speed up as the tree
+                    // fills with proven and transposed nodes.
+                    const double interval = std::chrono::duration<double>(now - last_check).count();
+                    if (interval > 0.0)
+                    {
+                        fastest_rate = std::max(fastest_rate, (result.simulations - last_check_simulations) / interval);
+                    }
+                    last_check = now;
+                    last_check_simulations = result.simulations;
+                    const double bound = DEADLINE_RATE_MARGIN * fastest_rate *
+                                             std::chrono::duration<double>(deadline - now).count() +
+                                         limits.checkInterval;
+                    remaining = static_cast<int>(std::min<double>(remaining, bound));
+                }
+                if (remaining != std::numeric_limits<int>::max() && checkDecided(root, limits, remaining, capped))
+                {
+                    result.stopReason = StopReason::DECIDED;
+                    break;
+                }
+            }
+
+            mcts_.expand(&root);
+            ++result.simulations;
+        }
+
+        if (result.stopReason != StopReason::CANCELLED)
+        {
+            // A cancellation that arrived too late for this search is not meant for the next one.
+            cancelled_.store(false);
+        }
+
+        result.bestMove = root.getBestMove();
+        result.rootStatistics = root.encode();
+        result.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start);
+        result.stats = mcts_.getStats();
+        result.stats.nodes = countNodes(root);
+        result.stats.bytes = countBytes(root);
+        result.stats.elapsed = result.elapsed;
+        return result;
+    }
+
+    bool AnytimeSearch::checkDecided(TreeNode &root, const SearchLimits &limits, int remaining, int capped)
+    {
+        if (!limits.stopWhenDecided && !limits.pruneUnreachable)
+        {
+            return false;
+        }
+
+        // Earlier exclusions were made against a leader that a proof may since have taken out.
+        root.clearExcludedMoves();
+
+        // The leader is the move TreeNode::getBestMove() would play now, which is never a
+        // proven loss while the root is unproven.
+        const int leader = root.getBestMove();
+        const auto &children = root.getChildStates();
+        // A proven leader gets no more visits, and the ranking of a proven move doesn't
+        // follow visits.
+        if (leader == -1 || children[leader]->isProven())
+        {
+            return false;
+        }
+        // A proven draw overtakes the leader as soon as its value drops to 0, whatever the
+        // visits, so the search can't stop early while there is one.
+        bool anyDraw = false;
+        const int leaderVisits = children[leader]->getVisits();
+        int runnerUpVisits = 0;
+        for (size_t move = 0; move < children.size(); ++move)
+        {
+            if (children[move] == nullptr || static_cast<int>(move) == leader)
+            {
+                continue;
+            }
+            if (!children[move]->isProven())
+            {
+                runnerUpVisits = std::max(runnerUpVisits, children[move]->getVisits());
+            }
+            else if (children[move]->getProvenWinner() == Player::NONE)
+            {
+                anyDraw = true;
+            }
+        }
+
+        if (limits.pruneUnreachable && capped != std::numeric_limits<int>::max())
+        {
+            for (size_t move = 0; move < children.size(); ++move)
+            {
+                if (children[move] != nullptr && static_cast<int>(move) != leader &&
+                    children[move]->getVisits() + capped < leaderVisits)
+                {
+                    root.excludeMove(static_cast<int>(move));
+                }
+            }
+        }
+
+        // Even a tie is out of reach: ties go to the lower move, whichever it is.
+        return limits.stopWhenDecided && !anyDraw && leaderVisits - runnerUpVisits > remaining;
+    }
+
+    void AnytimeSearch::cancel()
+    {
+        cancelled_.store(true);
+    }
+
+    void AnytimeSearch::setNodePool(NodePool *pool)
+    {
+        mcts_.setNodePool(pool);
+    }
+
+    void AnytimeSearch::setDetailedTiming(bool enabled)
+    {
+        mcts_.setDetailedTiming(enabled);
+    }
+
+} // namespace scout
@@ -0,0 +1,103 @@
+#ifndef WASM_SCOUT_LIB_ANYTIME_SEARCH_H
+#define WASM_SCOUT_LIB_ANYTIME_SEARCH_H
+
+#include <atomic>
+#include <chrono>
+#include <optional>
+#include <vector>
+
+#include "lib/game.h"
+#include "lib/mcts.h"
+
+namespace scout
+{
+
+    // When an AnytimeSearch should stop. Unset limits don't apply; with no limit at all,
+    // the search runs until it is cancelled or the root is proven.
+    struct SearchLimits
+    {
+        // Wall-clock budget, measured from the start of the search.
+        std::optional<std::chrono::milliseconds> deadline;
+        // Maximum number of simulations.
+        std::optional<int> maxSimulations;
+        // The clock and the cancellation flag are checked once every this many simulations.
+        int checkInterval = 16;
+        // Stop as soon as no other root move can overtake the most visited one within the
+        // remaining budget; the chosen move is then the one the full budget would have
+        // chosen, unless the simulations left would have proven a root move's result. With
+        // a deadline, the remaining budget is bounded by the fastest rate seen so far,
+        // with a margin, so that a speed-up can't make the bound too small.
+        bool stopWhenDecided = false;
+        // Exclude root moves that can no longer overtake the most visited one from
+        // selection, so the remaining simulations go to the contenders. Only applies with
+        // maxSimulations, the one hard bound on what is left; the exclusions are worked out
+        // again at every check, so they follow the leader when a proof takes it out.
+        bool pruneUnreachable = false;
+    };
+
+    enum class StopReason
+    {
+        DEADLINE,
+        SIMULATIONS,
+        CANCELLED,
+        PROVEN,
+        DECIDED
+    };
+
+    // What an AnytimeSearch returns, whenever it stops.
+    struct SearchResult
+    {
+        // The move to play (TreeNode::getBestMove()), or -1 if the root has no moves.
+        int bestMove = -1;
+        // The root statistics in the TreeNode::encode() layout.
+        std::vector<float> rootStatistics;
+        int simulations = 0;
+        std::chrono::microseconds elapsed{0};
+        StopReason stopReason = StopReason::SIMULATIONS;
+        // Counters, phase times and the final tree size of this search.
+        SearchStats stats;
+    };
+
+    /**
+     * @brief Runs MonteCarloTreeSearch::expand() until a deadline, a simulation budget,
+     * a proof of the root, or a cancellation from another thread, whichever comes first.
+     *
+     * Unless the root is already proven, at least one simulation runs, so the result
+     * always has root statistics.
+     */
+    class AnytimeSearch
+    {
+    public:
+        AnytimeSearch(ExpansionStrategy strategy, Evaluator evaluator);
+
+        // Searches a new tree rooted at `state`.
+        SearchResult search(const GameState &state, const SearchLimits &limits);
+
+        // Continues the search of an existing tree.
+        SearchResult search(TreeNode &root, const SearchLimits &limits);
+
+        /**
+         * @brief Asks the running search to stop at its next check; safe to call from any
+         * thread. If no search is running, the next one stops at its first check.
+         */
+        void cancel();
+
+        // Takes new nodes from `pool`, within its byte budget; see MonteCarloTreeSearch::setNodePool().
+        void setNodePool(NodePool *pool);
+
+        // Fills in the stats' phase times; see MonteCarloTreeSearch::setDetailedTiming().
+        void setDetailedTiming(bool enabled);
+
+    private:
+        // Applies SearchLimits::stopWhenDecided and pruneUnreachable at a check, given upper
+        // bounds on the simulations left: `remaining` from every limit and `capped` from
+        // maxSimulations alone. Returns true if the search should stop.
+        static bool checkDecided(TreeNode &root, const SearchLimits &limits, int remaining, int capped);
+
+        MonteCarloTreeSearch mcts_;
+        std::atomic<bool> cancelled_{false};
+    };
+
+} // namespace scout
+
+#endif // WASM_SCOUT_LIB_ANYTIME_SEARCH_H
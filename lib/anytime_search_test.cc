@@ -0,0 +1,298 @@
+#include "lib/anytime_search.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+namespace scout
+{
+
+    namespace
+    {
+        // A uniform evaluator that takes about a millisecond per call, like a slow device.
+        Evaluator slowEvaluator()
+        {
+            ZeroValueUniformEvaluator uniform(GameState::NUM_MOVES);
+            return [uniform](const std::vector<TreeNode *> &nodes)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                uniform(nodes);
+            };
+        }
+
+        // Values positions by the score difference, so that some moves stand out.
+        void scoreDifferenceEvaluator(const std::vector<TreeNode *> &nodes)
+        {
+            for (TreeNode *node : nodes)
+            {
+                if (node == nullptr)
+                {
+                    continue;
+                }
+                const GameState &state = node->state();
+                const int difference = state.getScoreOne() - state.getScoreTwo();
+                const int moverDifference = state.getCurrentPlayer() == Player::ONE ? difference : -difference;
+                node->evaluation().setValue(std::tanh(moverDifference / 20.0f));
+                std::vector<float> &policy = node->evaluation().getPolicy();
+                std::fill(policy.begin(), policy.end(), 1.0f / GameState::NUM_MOVES);
+            }
+        }
+
+        std::unique_ptr<GameState> middlegamePosition()
+        {
+            auto state = std::make_unique<GameState>();
+            return state->move(8)->move(1)->move(7)->move(3);
+        }
+    }
+
+    TEST(AnytimeSearchTest, StopsAtSimulationBudget)
+    {
+        PredictiveUpperConfidenceBound pucb_strategy(1);
+        AnytimeSearch search(std::ref(pucb_strategy), ZeroValueUniformEvaluator(GameState::NUM_MOVES));
+
+        SearchLimits limits;
+        limits.maxSimulations = 300;
+        SearchResult result = search.search(GameState(), limits);
+
+        EXPECT_EQ(result.stopReason, StopReason::SIMULATIONS);
+        EXPECT_EQ(result.simulations, 300);
+        ASSERT_EQ(result.rootStatistics.size(), 1u + GameState::NUM_MOVES);
+        EXPECT_GE(result.bestMove, 0);
+        EXPECT_LT(result.bestMove, GameState::NUM_MOVES);
+    }
+
+    TEST(AnytimeSearchTest, ReportsSearchStats)
+    {
+        PredictiveUpperConfidenceBound pucb_strategy(1);
+        AnytimeSearch search(std::ref(pucb_strategy), ZeroValueUniformEvaluator(GameState::NUM_MOVES));
+        search.setDetailedTiming(true);
+        TreeNode root(middlegamePosition(), GameState::NUM_MOVES);
+
+        SearchLimits limits;
+        limits.maxSimulations = 300;
+        const SearchStats stats = search.search(root, limits).stats;
+
+        EXPECT_EQ(stats.simulations, 300u);
+        // Each simulation either expanded a leaf, with one row per move, or hit a proven node.
+        EXPECT_EQ(stats.evaluatorCalls + stats.terminalHits, stats.simulations);
+        EXPECT_EQ(stats.evaluatedRows, stats.evaluatorCalls * GameState::NUM_MOVES);
+        EXPECT_EQ(stats.batchSizes[3], stats.evaluatorCalls);
+        EXPECT_GT(stats.maxDepth, 1);
+        EXPECT_GT(stats.averageDepth(), 1.0);
+        EXPECT_LE(stats.averageDepth(), stats.maxDepth);
+        EXPECT_EQ(stats.nodes, countNodes(root));
+        EXPECT_EQ(stats.bytes, countBytes(root));
+        EXPECT_GT(stats.simulationsPerSecond(), 0.0);
+        EXPECT_GT(stats.selectionTime.count(), 0);
+        EXPECT_GT(stats.evaluationTime.count(), 0);
+        EXPECT_LE(stats.selectionTime + stats.expansionTime + stats.evaluationTime + stats.backpropagationTime,
+                  stats.elapsed);
+
+        // A second search counts only its own simulations, and without detailed timing
+        // it keeps the counters but not the phase times.
+        search.setDetailedTiming(false);
+        const SearchStats untimed = search.search(root, limits).stats;
+        EXPECT_EQ(untimed.simulations, 300u);
+        EXPECT_EQ(untimed.evaluatorCalls + untimed.terminalHits, untimed.simulations);
+        EXPECT_EQ(untimed.selectionTime.count(), 0);
+        EXPECT_EQ(untimed.evaluationTime.count(), 0);
+        EXPECT_EQ(untimed.backpropagationTime.count(), 0);
+    }
+
+    TEST(AnytimeSearchTest, StopsAtDeadline)
+    {
+        PredictiveUpperConfidenceBound pucb_strategy(1);
+        AnytimeSearch search(std::ref(pucb_strategy), slowEvaluator());
+
+        SearchLimits limits;
+        limits.deadline = std::chrono::milliseconds(50);
+        limits.checkInterval = 4;
+        SearchResult result = search.search(GameState(), limits);
+
+        EXPECT_EQ(result.stopReason, StopReason::DEADLINE);
+        EXPECT_GE(result.elapsed, std::chrono::milliseconds(50));
+        // At most one check interval of overrun, with plenty of slack for a loaded machine.
+        EXPECT_LT(result.elapsed, std::chrono::milliseconds(500));
+        EXPECT_GT(result.simulations, 0);
+    }
+
+    TEST(AnytimeSearchTest, CancelledFromAnotherThread)
+    {
+        PredictiveUpperConfidenceBound pucb_strategy(1);
+        AnytimeSearch search(std::ref(pucb_strategy), slowEvaluator());
+
+        std::thread canceller([&search]
+                              {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            search.cancel(); });
+        // No limits: only the cancellation stops the search.
+        SearchResult result = search.search(GameState(), SearchLimits());
+        canceller.join();
+
+        EXPECT_EQ(result.stopReason, StopReason::CANCELLED);
+        EXPECT_GT(result.simulations, 0);
+
+        // The cancellation was consumed.
+        SearchLimits limits;
+        limits.maxSimulations = 50;
+        EXPECT_EQ(search.search(GameState(), limits).stopReason, StopReason::SIMULATIONS);
+    }
+
+    TEST(AnytimeSearchTest, StopsWhenProven)
+    {
+        PredictiveUpperConfidenceBound pucb_strategy(1);
+        AnytimeSearch search(std::ref(pucb_strategy), ZeroValueUniformEvaluator(GameState::NUM_MOVES));
+
+        auto state = std::make_unique<GameState>();
+        state = state->move(8)->move(1)->move(7)->move(3)->move(6)->move(3)->move(4)->move(1)->move(8)->move(8);
+
+        SearchLimits limits;
+        limits.maxSimulations = 2000;
+        SearchResult result = search.search(*state, limits);
+
+        EXPECT_EQ(result.stopReason, StopReason::PROVEN);
+        EXPECT_EQ(result.simulations, 1);
+        EXPECT_EQ(result.bestMove, 8);
+    }
+
+    TEST(AnytimeSearchTest, StopsOnceDecided)
+    {
+        SearchLimits limits;
+        limits.maxSimulations = 2000;
+
+        PredictiveUpperConfidenceBound full_strategy(1);
+        AnytimeSearch full_search(std::ref(full_strategy), scoreDifferenceEvaluator);
+        SearchResult full = full_search.search(*middlegamePosition(), limits);
+
+        limits.stopWhenDecided = true;
+        PredictiveUpperConfidenceBound strategy(1);
+        AnytimeSearch search(std::ref(strategy), scoreDifferenceEvaluator);
+        SearchResult early = search.search(*middlegamePosition(), limits);
+
+        EXPECT_EQ(early.stopReason, StopReason::DECIDED);
+        EXPECT_LT(early.simulations, full.simulations);
+        EXPECT_EQ(early.bestMove, full.bestMove);
+    }
+
+    TEST(AnytimeSearchTest, PrunesUnreachableRootMoves)
+    {
+        PredictiveUpperConfidenceBound pucb_strategy(1);
+        AnytimeSearch search(std::ref(pucb_strategy), scoreDifferenceEvaluator);
+        TreeNode root(middlegamePosition(), GameState::NUM_MOVES);
+
+        SearchLimits limits;
+        limits.maxSimulations = 2000;
+        limits.pruneUnreachable = true;
+        SearchResult result = search.search(root, limits);
+        EXPECT_EQ(result.simulations, 2000);
+
+        const int leader_visits = root.getChildStates()[result.bestMove]->getVisits();
+        int excluded = 0;
+        for (int move = 0; move < GameState::NUM_MOVES; ++move)
+        {
+            if (root.isMoveExcluded(move))
+            {
+                ++excluded;
+                EXPECT_LT(root.getChildStates()[move]->getVisits(), leader_visits);
+            }
+        }
+        EXPECT_GT(excluded, 0);
+        EXPECT_FALSE(root.isMoveExcluded(result.bestMove));
+    }
+
+    TEST(AnytimeSearchTest, DoesNotPruneAgainstADeadline)
+    {
+        PredictiveUpperConfidenceBound pucb_strategy(1);
+        AnytimeSearch search(std::ref(pucb_strategy), scoreDifferenceEvaluator);
+        TreeNode root(middlegamePosition(), GameState::NUM_MOVES);
+
+        // How many simulations fit before a deadline is only an estimate.
+        SearchLimits limits;
+        limits.deadline = std::chrono::milliseconds(50);
+        limits.pruneUnreachable = true;
+        search.search(root, limits);
+        for (int move = 0; move < GameState::NUM_MOVES; ++move)
+        {
+            EXPECT_FALSE(root.isMoveExcluded(move));
+        }
+    }
+
+    TEST(AnytimeSearchTest, PruningFollowsALeaderProvenLost)
+    {
+        TreeNode root(middlegamePosition(), GameState::NUM_MOVES);
+        const Player mover = root.state().getCurrentPlayer();
+        int favourite = 0;
+        while (!root.state().isMoveAllowed(favourite))
+        {
+            ++favourite;
+        }
+        // The root's prior draws most simulations to the favourite, making it the leader.
+        std::vector<float> &prior = root.evaluation().getPolicy();
+        std::fill(prior.begin(), prior.end(), 0.1f / GameState::NUM_MOVES);
+        prior[favourite] = 0.9f;
+
+        // Late in the search, after the other moves were pruned, the favourite turns out
+        // to be lost, as if an endgame solver had proven it.
+        const int proof_call = 1500;
+        int calls = 0;
+        std::vector<int> visits_at_proof(GameState::NUM_MOVES, 0);
+        ZeroValueUniformEvaluator uniform(GameState::NUM_MOVES);
+        Evaluator proving_evaluator = [&](const std::vector<TreeNode *> &nodes)
+        {
+            if (++calls == proof_call)
+            {
+                EXPECT_TRUE(root.isMoveExcluded(favourite == 0 ? 1 : 0));
+                for (int move = 0; move < GameState::NUM_MOVES; ++move)
+                {
+                    const auto &child = root.getChildStates()[move];
+                    visits_at_proof[move] = child != nullptr ? child->getVisits() : 0;
+                }
+                root.getChildStates()[favourite]->setProvenWinner(mover == Player::ONE ? Player::TWO : Player::ONE);
+            }
+            uniform(nodes);
+        };
+
+        PredictiveUpperConfidenceBound pucb_strategy(1);
+        AnytimeSearch search(std::ref(pucb_strategy), proving_evaluator);
+        SearchLimits limits;
+        limits.maxSimulations = 2000;
+        limits.pruneUnreachable = true;
+        SearchResult result = search.search(root, limits);
+        ASSERT_GE(calls, proof_call);
+
+        // The moves pruned against the favourite were searched again, and one of them is played.
+        EXPECT_NE(result.bestMove, favourite);
+        int moves_searched_after_proof = 0;
+        for (int move = 0; move < GameState::NUM_MOVES; ++move)
+        {
+            const auto &child = root.getChildStates()[move];
+            if (child != nullptr && move != favourite && child->getVisits() > visits_at_proof[move])
+            {
+                ++moves_searched_after_proof;
+            }
+        }
+        EXPECT_GT(moves_searched_after_proof, 1);
+        EXPECT_FALSE(root.isMoveExcluded(result.bestMove));
+    }
+
+    TEST(AnytimeSearchTest, ContinuesExistingTree)
+    {
+        PredictiveUpperConfidenceBound pucb_strategy(1);
+        AnytimeSearch search(std::ref(pucb_strategy), ZeroValueUniformEvaluator(GameState::NUM_MOVES));
+        TreeNode root(std::make_unique<GameState>(), GameState::NUM_MOVES);
+
+        SearchLimits limits;
+        limits.maxSimulations = 100;
+        search.search(root, limits);
+        search.search(root, limits);
+
+        EXPECT_EQ(root.getVisits(), 200);
+        EXPECT_THROW(search.search(*GameState().move(8)->move(1)->move(7)->move(3)->move(6)->move(3)->move(4)->move(1)->move(8)->move(8)->move(8), limits),
+                     std::invalid_argument);
+    }
+
+} // namespace scout
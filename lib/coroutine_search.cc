@@ -0,0 +1,169 @@
+#include "lib/coroutine_search.h"
+
+#include <chrono>
+#include <utility>
+
+namespace scout
+{
+
+    CoroutineSearch::Task::~Task()
+    {
+        if (handle_)
+        {
+            handle_.destroy();
+        }
+    }
+
+    void CoroutineSearch::BatchAwaiter::await_suspend(std::coroutine_handle<> handle)
+    {
+        if (leaf != nullptr)
+        {
+            search.pending_leaves_.push_back(leaf);
+        }
+        search.waiting_.push_back(handle);
+    }
+
+    CoroutineSearch::CoroutineSearch(ExpansionStrategy strategy, Evaluator evaluator)
+        : expansion_strategy_(std::move(strategy)),
+          evaluator_(std::move(evaluator)) {}
+
+    int CoroutineSearch::search(TreeNode *rootNode, int simulations, int concurrency)
+    {
+        if (!rootNode || simulations <= 0)
+            return 0;
+
+        const auto start = std::chrono::steady_clock::now();
+        remaining_ = simulations;
+        stats_ = SearchStats();
+
+        // Leftovers of a search aborted by an exception refer to destroyed coroutines.
+        runnable_.clear();
+        waiting_.clear();
+        pending_leaves_.clear();
+
+        std::vector<Task> tasks;
+        tasks.reserve(concurrency);
+        for (int i = 0; i < concurrency; ++i)
+        {
+            tasks.push_back(simulationLoop(rootNode));
+            runnable_.push_back(tasks.back().handle());
+        }
+
+        int evaluator_calls = 0;
+        while (!runnable_.empty())
+        {
+            // Each simulation runs until it waits for a batch or the budget is used up.
+            for (auto handle : runnable_)
+            {
+                handle.resume();
+            }
+            runnable_.clear();
+
+            for (const Task &task : tasks)
+            {
+                if (task.handle().done() && task.handle().promise().error)
+                {
+                    std::rethrow_exception(task.handle().promise().error);
+                }
+            }
+
+            if (!pending_leaves_.empty())
+            {
+                ++evaluator_calls;
+            }
+            evaluateBatch();
+        }
+
+        stats_.nodes = countNodes(*rootNode);
+        stats_.bytes = countBytes(*rootNode);
+        stats_.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        return evaluator_calls;
+    }
+
+    void CoroutineSearch::evaluateBatch()
+    {
+        using Clock = std::chrono::steady_clock;
+        const Clock::time_point expansion_start = phaseClock();
+        batch_nodes_.clear();
+        for (TreeNode *leaf : pending_leaves_)
+        {
+            leaf->createChildren();
+            leaf->appendNewChildren(batch_nodes_);
+        }
+        pending_leaves_.clear();
+
+        const Clock::time_point evaluation_start = phaseClock();
+        stats_.expansionTime += evaluation_start - expansion_start;
+        if (!batch_nodes_.empty())
+        {
+            evaluator_(batch_nodes_);
+            stats_.recordBatch(batch_nodes_.size());
+        }
+        stats_.evaluationTime += phaseClock() - evaluation_start;
+
+        runnable_.swap(waiting_);
+    }
+
+    CoroutineSearch::Task CoroutineSearch::simulationLoop(TreeNode *rootNode)
+    {
+        using Clock = std::chrono::steady_clock;
+        std::vector<TreeNode *> path;
+        // Times a backup and counts its simulation.
+        auto backUp = [this, &path](Player winner, const AverageValue &value)
+        {
+            const Clock::time_point start = phaseClock();
+            backpropagate(path, winner, value);
+            stats_.backpropagationTime += phaseClock() - start;
+            stats_.recordSimulation(static_cast<int>(path.size()) - 1);
+        };
+
+        while (remaining_ > 0 && !rootNode->isProven())
+        {
+            --remaining_;
+            const Clock::time_point start = phaseClock();
+            selectPath(rootNode, expansion_strategy_, path);
+            stats_.selectionTime += phaseClock() - start;
+            TreeNode *leaf = path.back();
+
+            if (leaf->isProven())
+            {
+                // The simulation result is the game result under perfect play.
+                Player winner = leaf->getProvenWinner().value();
+                AverageValue result;
+                result.addWinner(winner);
+                ++stats_.terminalHits;
+                backUp(winner, result);
+                continue;
+            }
+
+            if (leaf->isInitialized())
+            {
+                // The depth limit was hit: back up a tie with no value.
+                backUp(Player::NONE, AverageValue());
+                continue;
+            }
+
+            if (leaf->getVirtualLoss() > 0)
+            {
+                // Another simulation is waiting for this leaf; retry once its batch is done.
+                ++remaining_;
+                co_await BatchAwaiter{*this, nullptr};
+                continue;
+            }
+
+            for (TreeNode *node : path)
+            {
+                node->addVirtualLoss();
+            }
+
+            co_await BatchAwaiter{*this, leaf};
+
+            for (TreeNode *node : path)
+            {
+                node->removeVirtualLoss();
+            }
+            backUp(leaf->state().getCurrentPlayer(), leaf->collectChildrenValue());
+        }
+    }
+
+} // namespace scout
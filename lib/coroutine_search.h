@@ -0,0 +1,111 @@
+#ifndef WASM_SCOUT_LIB_COROUTINE_SEARCH_H
+#define WASM_SCOUT_LIB_COROUTINE_SEARCH_H
+
+#include <chrono>
+#include <coroutine>
+#include <exception>
+#include <vector>
+
+#include "lib/mcts.h"
+
+namespace scout
+{
+
+    /**
+     * @brief A search driver that runs many simulations concurrently on one thread.
+     *
+     * Every simulation is a C++20 coroutine. It descends with virtual loss and, when
+     * its leaf needs a network evaluation, suspends. Once all runnable simulations are
+     * suspended, the scheduler evaluates the children of every waiting leaf with a
+     * single evaluator call and resumes the simulations, which back their results up
+     * and start the next descent. There are no threads, so there are no locks.
+     */
+    class CoroutineSearch
+    {
+    public:
+        CoroutineSearch(ExpansionStrategy strategy, Evaluator evaluator);
+
+        /**
+         * @brief Runs `simulations` simulations from `rootNode`, or fewer if the root gets proven.
+         * @param concurrency The number of simulations in flight; it bounds the number of
+         *        leaves (about 9 rows each) per evaluator call.
+         * @return The number of evaluator calls made.
+         */
+        int search(TreeNode *rootNode, int simulations, int concurrency);
+
+        // Fills in the stats' phase times; see MonteCarloTreeSearch::setDetailedTiming().
+        void setDetailedTiming(bool enabled) { detailed_timing_ = enabled; }
+
+        // The statistics of the last search.
+        const SearchStats &getLastStats() const { return stats_; }
+
+    private:
+        // The coroutine type of one simulation loop. It starts suspended and is owned
+        // (and destroyed) by the returned object.
+        class Task
+        {
+        public:
+            struct promise_type
+            {
+                Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+                std::suspend_always initial_suspend() noexcept { return {}; }
+                std::suspend_always final_suspend() noexcept { return {}; }
+                void return_void() {}
+                void unhandled_exception() { error = std::current_exception(); }
+
+                std::exception_ptr error;
+            };
+
+            explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+            Task(Task &&other) noexcept : handle_(other.handle_) { other.handle_ = nullptr; }
+            Task(const Task &) = delete;
+            Task &operator=(const Task &) = delete;
+            ~Task();
+
+            std::coroutine_handle<promise_type> handle() const { return handle_; }
+
+        private:
+            std::coroutine_handle<promise_type> handle_;
+        };
+
+        // Suspends a simulation until the next batch has been evaluated. With a leaf,
+        // the leaf's children are created and evaluated in that batch.
+        struct BatchAwaiter
+        {
+            CoroutineSearch &search;
+            TreeNode *leaf;
+
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> handle);
+            void await_resume() const noexcept {}
+        };
+
+        // Runs simulations from `rootNode` until the shared budget is used up.
+        Task simulationLoop(TreeNode *rootNode);
+
+        // Evaluates the pending leaves and makes their simulations runnable again.
+        void evaluateBatch();
+
+        // The time now with detailed timing on, else a fixed time point.
+        std::chrono::steady_clock::time_point phaseClock() const
+        {
+            return detailed_timing_ ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+        }
+
+        ExpansionStrategy expansion_strategy_;
+        Evaluator evaluator_;
+
+        // Simulations not yet started in the current search.
+        int remaining_ = 0;
+
+        std::vector<std::coroutine_handle<>> runnable_;
+        std::vector<std::coroutine_handle<>> waiting_;
+        std::vector<TreeNode *> pending_leaves_;
+        std::vector<TreeNode *> batch_nodes_;
+        bool detailed_timing_ = false;
+        SearchStats stats_;
+    };
+
+} // namespace scout
+
+#endif // WASM_SCOUT_LIB_COROUTINE_SEARCH_H
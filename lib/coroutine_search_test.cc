@@ -0,0 +1,78 @@
+#include "lib/coroutine_search.h"
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+
+#include "gtest/gtest.h"
+
+namespace scout
+{
+
+    TEST(CoroutineSearchTest, RunsEverySimulation)
+    {
+        ZeroValueUniformEvaluator uniform(GameState::NUM_MOVES);
+        int evaluator_calls = 0;
+        size_t largest_batch = 0;
+        Evaluator counting_evaluator = [&](const std::vector<TreeNode *> &nodes)
+        {
+            ++evaluator_calls;
+            largest_batch = std::max(largest_batch, nodes.size());
+            uniform(nodes);
+        };
+
+        PredictiveUpperConfidenceBound pucb_strategy(1);
+        CoroutineSearch search(std::ref(pucb_strategy), counting_evaluator);
+        TreeNode root(std::make_unique<GameState>(), GameState::NUM_MOVES);
+
+        const int calls = search.search(&root, 1000, 32);
+
+        EXPECT_EQ(root.getVisits(), 1000);
+        EXPECT_EQ(calls, evaluator_calls);
+        // The first batch holds the root alone; the others fill up with many leaves.
+        EXPECT_LT(evaluator_calls, 100);
+        EXPECT_GT(largest_batch, 16u * GameState::NUM_MOVES);
+
+        const SearchStats &stats = search.getLastStats();
+        EXPECT_EQ(stats.simulations, 1000u);
+        EXPECT_EQ(stats.evaluatorCalls, static_cast<std::uint64_t>(evaluator_calls));
+        EXPECT_EQ(stats.nodes, countNodes(root));
+
+        EXPECT_EQ(root.getVirtualLoss(), 0);
+        for (const auto &child : root.getChildStates())
+        {
+            EXPECT_EQ(child->getVirtualLoss(), 0);
+        }
+
+        // A second search continues on the same tree.
+        search.search(&root, 500, 8);
+        EXPECT_EQ(root.getVisits(), 1500);
+    }
+
+    TEST(CoroutineSearchTest, FindsWinningMove)
+    {
+        PredictiveUpperConfidenceBound pucb_strategy(1);
+        CoroutineSearch search(std::ref(pucb_strategy), ZeroValueUniformEvaluator(GameState::NUM_MOVES));
+
+        auto root_state = std::make_unique<GameState>();
+        root_state = root_state->move(8)->move(1)->move(7)->move(3)->move(6)->move(3)->move(4)->move(1)->move(8)->move(8);
+        TreeNode root(std::move(root_state), GameState::NUM_MOVES);
+
+        search.search(&root, 2000, 16);
+
+        auto encoded = root.encode();
+        EXPECT_EQ(std::max_element(encoded.begin() + 1, encoded.end()) - encoded.begin() - 1, 8);
+    }
+
+    TEST(CoroutineSearchTest, PropagatesEvaluatorErrors)
+    {
+        Evaluator failing = [](const std::vector<TreeNode *> &)
+        { throw std::runtime_error("model failure"); };
+        PredictiveUpperConfidenceBound pucb_strategy(1);
+        CoroutineSearch search(std::ref(pucb_strategy), failing);
+        TreeNode root(std::make_unique<GameState>(), GameState::NUM_MOVES);
+
+        EXPECT_THROW(search.search(&root, 10, 4), std::runtime_error);
+    }
+
+} // namespace scout
@@ -0,0 +1,212 @@
+#include "lib/endgame_solver.h"
+
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+
+namespace scout
+{
+
+    namespace
+    {
+        // The result of a finished game for `player`.
+        int resultFor(const GameState &state, Player player)
+        {
+            const Player winner = state.getWinner().value_or(Player::NONE);
+            if (winner == Player::NONE)
+            {
+                return 0;
+            }
+            return winner == player ? 1 : -1;
+        }
+
+        int scoreOf(const GameState &state, Player player)
+        {
+            return player == Player::ONE ? state.getScoreOne() : state.getScoreTwo();
+        }
+    }
+
+    EndgameSolver::EndgameSolver(Evaluator evaluator, int maxStones, int nodeBudget)
+        : evaluator_(std::move(evaluator)),
+          max_stones_(maxStones),
+          node_budget_(nodeBudget)
+    {
+        if (nodeBudget <= 0)
+        {
+            throw std::invalid_argument("The node budget must be positive.");
+        }
+    }
+
+    void EndgameSolver::operator()(const std::vector<TreeNode *> &nodes)
+    {
+        std::vector<TreeNode *> unsolved;
+        unsolved.reserve(nodes.size());
+        for (TreeNode *node : nodes)
+        {
+            if (node == nullptr)
+            {
+                continue;
+            }
+            const GameState &state = node->state();
+            std::optional<Player> winner;
+            if (!state.isGameOver() && stonesOnBoard(state) <= max_stones_)
+            {
+                winner = solve(state);
+                ++(winner.has_value() ? solved_ : unsolved_);
+            }
+            if (!winner.has_value())
+            {
+                unsolved.push_back(node);
+                continue;
+            }
+
+            // The exact value, and a uniform policy: a proven node is never expanded.
+            const Player mover = state.getCurrentPlayer();
+            StateEvaluation &evaluation = node->evaluation();
+            evaluation.setValue(*winner == Player::NONE ? 0.0f : (*winner == mover ? 1.0f : -1.0f));
+            std::vector<float> &policy = evaluation.getPolicy();
+            int legal = 0;
+            for (int move = 0; move < static_cast<int>(policy.size()); ++move)
+            {
+                legal += state.isMoveAllowed(move) ? 1 : 0;
+            }
+            for (int move = 0; move < static_cast<int>(policy.size()); ++move)
+            {
+                policy[move] = state.isMoveAllowed(move) ? 1.0f / legal : 0.0f;
+            }
+            node->setProvenWinner(*winner);
+        }
+
+        if (!unsolved.empty())
+        {
+            evaluator_(unsolved);
+        }
+    }
+
+    std::optional<Player> EndgameSolver::solve(const GameState &state) const
+    {
+        if (state.isGameOver())
+        {
+            return state.getWinner().value_or(Player::NONE);
+        }
+        Search search{node_budget_, {}};
+        const std::optional<int> result = negamax(state, -1, 1, 0, search);
+        searched_positions_ += node_budget_ - std::max(search.budget, 0);
+        if (!result.has_value())
+        {
+            return std::nullopt;
+        }
+        const Player mover = state.getCurrentPlayer();
+        if (*result == 0)
+        {
+            return Player::NONE;
+        }
+        return *result > 0 ? mover : opponent(mover);
+    }
+
+    int EndgameSolver::stonesOnBoard(const GameState &state)
+    {
+        const std::vector<int> cells = state.getCells();
+        return std::accumulate(cells.begin(), cells.end(), 0);
+    }
+
+    std::optional<int> EndgameSolver::negamax(const GameState &state, int alpha, int beta, int depth, Search &search) const
+    {
+        if (--search.budget < 0 || depth >= MAX_DEPTH)
+        {
+            return std::nullopt;
+        }
+
+        const std::uint64_t key = state.hash();
+        if (auto it = search.bounds.find(key); it != search.bounds.end())
+        {
+            const Bounds known = it->second;
+            if (known.lower >= beta || known.lower == known.upper)
+            {
+                return known.lower;
+            }
+            if (known.upper <= alpha)
+            {
+                return known.upper;
+            }
+            alpha = std::max<int>(alpha, known.lower);
+            beta = std::min<int>(beta, known.upper);
+        }
+        const int original_alpha = alpha;
+
+        const Player mover = state.getCurrentPlayer();
+        std::array<GameState, GameState::NUM_MOVES> children;
+        std::array<int, GameState::NUM_MOVES> order;
+        std::array<int, GameState::NUM_MOVES> gain;
+        int count = 0;
+        for (int move = 0; move < GameState::NUM_MOVES; ++move)
+        {
+            if (!state.isMoveAllowed(move))
+            {
+                continue;
+            }
+            children[count] = state.afterMove(move);
+            const GameState &child = children[count];
+            // Finished games first, a win above all, then the moves that score the most.
+            gain[count] = child.isGameOver() ? 1000 * resultFor(child, mover) : scoreOf(child, mover) - scoreOf(state, mover);
+            order[count] = count;
+            ++count;
+        }
+        std::sort(order.begin(), order.begin() + count, [&](int a, int b)
+                  { return gain[a] > gain[b]; });
+
+        int best = -2;
+        for (int i = 0; i < count; ++i)
+        {
+            const GameState &child = children[order[i]];
+            int value;
+            if (child.isGameOver())
+            {
+                value = resultFor(child, mover);
+            }
+            else if (child.getCurrentPlayer() == mover)
+            {
+                const std::optional<int> result = negamax(child, alpha, beta, depth + 1, search);
+                if (!result.has_value())
+                {
+                    return std::nullopt;
+                }
+                value = *result;
+            }
+            else
+            {
+                const std::optional<int> result = negamax(child, -beta, -alpha, depth + 1, search);
+                if (!result.has_value())
+                {
+                    return std::nullopt;
+                }
+                value = -*result;
+            }
+            best = std::max(best, value);
+            alpha = std::max(alpha, value);
+            if (alpha >= beta)
+            {
+                break;
+            }
+        }
+
+        // Fail-soft: a result outside the window is only a bound.
+        Bounds &known = search.bounds[key];
+        if (best <= original_alpha)
+        {
+            known.upper = static_cast<std::int8_t>(best);
+        }
+        else if (best >= beta)
+        {
+            known.lower = static_cast<std::int8_t>(best);
+        }
+        else
+        {
+            known.lower = known.upper = static_cast<std::int8_t>(best);
+        }
+        return best;
+    }
+
+} // namespace scout
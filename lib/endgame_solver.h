@@ -0,0 +1,96 @@
+#ifndef WASM_SCOUT_LIB_ENDGAME_SOLVER_H
+#define WASM_SCOUT_LIB_ENDGAME_SOLVER_H
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "lib/game.h"
+#include "lib/mcts.h"
+
+namespace scout
+{
+
+    /**
+     * @brief An Evaluator that solves endgame leaves exactly instead of asking the model.
+     *
+     * A leaf with at most `maxStones` stones on the board is searched to the end of the
+     * game by alpha-beta, within a budget of positions. If the search finishes, the leaf
+     * gets the exact value and is marked proven, so the tree never expands or evaluates
+     * it again; otherwise it goes to the wrapped evaluator with the other leaves, as a
+     * single smaller batch.
+     *
+     * The stones on the board are what the players still compete for: they are the 162
+     * stones of the game less both scores, so the threshold also bounds the margin left
+     * to either player's winning 82.
+     *
+     * Like EvaluationCache, the solver is not copyable; pass it as std::ref(solver).
+     */
+    class EndgameSolver
+    {
+    public:
+        static constexpr int DEFAULT_NODE_BUDGET = 20000;
+        // Deeper lines, e.g. stones circling without captures, count as unsolved.
+        static constexpr int MAX_DEPTH = 64;
+
+        /**
+         * @param evaluator The evaluator for the leaves that aren't solved.
+         * @param maxStones Leaves with at most this many stones on the board are solved.
+         * @param nodeBudget The most positions a single leaf's search may visit.
+         */
+        EndgameSolver(Evaluator evaluator, int maxStones, int nodeBudget = DEFAULT_NODE_BUDGET);
+
+        EndgameSolver(const EndgameSolver &) = delete;
+        EndgameSolver &operator=(const EndgameSolver &) = delete;
+
+        // Solves what it can of `nodes` and runs the wrapped evaluator on the rest.
+        void operator()(const std::vector<TreeNode *> &nodes);
+
+        /**
+         * @brief Searches `state` to the end of the game.
+         * @return The winner under perfect play (Player::NONE for a draw), or nullopt if
+         * the search ran out of its budget.
+         */
+        std::optional<Player> solve(const GameState &state) const;
+
+        // Stones in the pits of both players.
+        static int stonesOnBoard(const GameState &state);
+
+        // Leaves solved, and leaves whose search ran out of budget.
+        std::uint64_t getSolved() const { return solved_; }
+        std::uint64_t getUnsolved() const { return unsolved_; }
+        // Positions visited by all searches.
+        std::uint64_t getSearchedPositions() const { return searched_positions_; }
+
+    private:
+        // What one search knows about a position's result: lower <= result <= upper.
+        struct Bounds
+        {
+            std::int8_t lower = -1;
+            std::int8_t upper = 1;
+        };
+
+        struct Search
+        {
+            int budget;
+            // Keyed by GameState::hash(); transpositions are common once few stones are left.
+            std::unordered_map<std::uint64_t, Bounds> bounds;
+        };
+
+        // The result for the player to move: 1 for a win, 0 for a draw and -1 for a loss,
+        // or nullopt once the budget is spent.
+        std::optional<int> negamax(const GameState &state, int alpha, int beta, int depth, Search &search) const;
+
+        Evaluator evaluator_;
+        const int max_stones_;
+        const int node_budget_;
+        std::atomic<std::uint64_t> solved_{0};
+        std::atomic<std::uint64_t> unsolved_{0};
+        mutable std::atomic<std::uint64_t> searched_positions_{0};
+    };
+
+} // namespace scout
+
+#endif // WASM_SCOUT_LIB_ENDGAME_SOLVER_H
@@ -0,0 +1,156 @@
+#include "lib/endgame_solver.h"
+
+#include <functional>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace scout
+{
+
+    namespace
+    {
+        // Positions from random games, taken once at most `stones` stones are left on the board.
+        std::vector<GameState> endgamePositions(int count, int stones, unsigned seed)
+        {
+            std::mt19937 random(seed);
+            std::vector<GameState> positions;
+            while (static_cast<int>(positions.size()) < count)
+            {
+                GameState state;
+                while (!state.isGameOver() && EndgameSolver::stonesOnBoard(state) > stones)
+                {
+                    std::vector<int> moves;
+                    for (int move = 0; move < GameState::NUM_MOVES; ++move)
+                    {
+                        if (state.isMoveAllowed(move))
+                        {
+                            moves.push_back(move);
+                        }
+                    }
+                    state = state.afterMove(moves[random() % moves.size()]);
+                }
+                if (!state.isGameOver())
+                {
+                    positions.push_back(state);
+                }
+            }
+            return positions;
+        }
+
+        // Plain minimax over every line, as a reference for the solver.
+        int minimax(const GameState &state, Player player, int depth)
+        {
+            if (state.isGameOver())
+            {
+                const Player winner = state.getWinner().value_or(Player::NONE);
+                return winner == Player::NONE ? 0 : (winner == player ? 1 : -1);
+            }
+            if (depth == 0)
+            {
+                ADD_FAILURE() << "The reference search is too shallow.";
+                return 0;
+            }
+            const bool maximizing = state.getCurrentPlayer() == player;
+            int best = maximizing ? -2 : 2;
+            for (int move = 0; move < GameState::NUM_MOVES; ++move)
+            {
+                if (state.isMoveAllowed(move))
+                {
+                    const int value = minimax(state.afterMove(move), player, depth - 1);
+                    best = maximizing ? std::max(best, value) : std::min(best, value);
+                }
+            }
+            return best;
+        }
+
+        // A uniform evaluator that counts the rows it is given.
+        Evaluator countingEvaluator(int &rows)
+        {
+            ZeroValueUniformEvaluator uniform(GameState::NUM_MOVES);
+            return [uniform, &rows](const std::vector<TreeNode *> &nodes)
+            {
+                for (TreeNode *node : nodes)
+                {
+                    rows += node != nullptr ? 1 : 0;
+                }
+                uniform(nodes);
+            };
+        }
+    }
+
+    TEST(EndgameSolverTest, AgreesWithMinimax)
+    {
+        EndgameSolver solver(ZeroValueUniformEvaluator(GameState::NUM_MOVES), 5, 1 << 20);
+        for (const GameState &position : endgamePositions(20, 5, 1))
+        {
+            const std::optional<Player> winner = solver.solve(position);
+            ASSERT_TRUE(winner.has_value()) << position.toString();
+            const Player mover = position.getCurrentPlayer();
+            const int expected = minimax(position, mover, EndgameSolver::MAX_DEPTH);
+            const int actual = *winner == Player::NONE ? 0 : (*winner == mover ? 1 : -1);
+            EXPECT_EQ(actual, expected) << position.toString();
+        }
+    }
+
+    TEST(EndgameSolverTest, SolvedLeavesSkipTheEvaluator)
+    {
+        const GameState position = endgamePositions(1, 10, 2).front();
+        int rows = 0;
+        EndgameSolver solver(countingEvaluator(rows), 10);
+        PredictiveUpperConfidenceBound pucb_strategy(1);
+        MonteCarloTreeSearch mcts(std::ref(pucb_strategy), std::ref(solver));
+
+        TreeNode root(std::make_unique<GameState>(position), GameState::NUM_MOVES);
+        for (int i = 0; i < 200 && !root.isProven(); ++i)
+        {
+            mcts.expand(&root);
+        }
+
+        // Every child was solved, so the root is proven on its first expansion.
+        EXPECT_EQ(rows, 0);
+        EXPECT_GT(solver.getSolved(), 0u);
+        EXPECT_EQ(solver.getUnsolved(), 0u);
+        ASSERT_TRUE(root.isProven());
+        EXPECT_EQ(root.getProvenWinner(), solver.solve(position));
+        for (const auto &child : root.getChildStates())
+        {
+            if (child != nullptr)
+            {
+                EXPECT_TRUE(child->isProven());
+            }
+        }
+    }
+
+    TEST(EndgameSolverTest, LeavesOverTheBudgetGoToTheEvaluator)
+    {
+        const GameState position = endgamePositions(1, 10, 3).front();
+        int rows = 0;
+        EndgameSolver solver(countingEvaluator(rows), 10, 1);
+        TreeNode root(std::make_unique<GameState>(position), GameState::NUM_MOVES);
+        root.initChildren(std::ref(solver));
+
+        int children = 0;
+        for (const auto &child : root.getChildStates())
+        {
+            if (child != nullptr && !child->state().isGameOver())
+            {
+                ++children;
+                EXPECT_FALSE(child->isProven());
+            }
+        }
+        EXPECT_EQ(rows, children);
+        EXPECT_EQ(solver.getSolved(), 0u);
+        EXPECT_EQ(solver.getUnsolved(), static_cast<std::uint64_t>(children));
+    }
+
+    TEST(EndgameSolverTest, CountsStonesOnTheBoard)
+    {
+        EXPECT_EQ(EndgameSolver::stonesOnBoard(GameState()), 162);
+        const GameState position = endgamePositions(1, 10, 4).front();
+        EXPECT_EQ(EndgameSolver::stonesOnBoard(position) + position.getScoreOne() + position.getScoreTwo(), 162);
+    }
+
+} // namespace scout
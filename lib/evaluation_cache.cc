@@ -0,0 +1,153 @@
+#include "lib/evaluation_cache.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace scout
+{
+
+    EvaluationCache::EvaluationCache(Evaluator evaluator, size_t memoryBudgetBytes)
+        : evaluator_(std::move(evaluator)),
+          capacity_(memoryBudgetBytes / bytesPerEntry())
+    {
+        if (capacity_ == 0)
+        {
+            throw std::invalid_argument("Memory budget is too small for a single evaluation.");
+        }
+        entries_.reserve(capacity_);
+        index_.reserve(capacity_);
+    }
+
+    void EvaluationCache::operator()(const std::vector<TreeNode *> &nodes)
+    {
+        std::unique_ptr<Misses> misses;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (spare_misses_.empty())
+            {
+                misses = std::make_unique<Misses>();
+            }
+            else
+            {
+                misses = std::move(spare_misses_.back());
+                spare_misses_.pop_back();
+            }
+            misses->nodes.clear();
+            misses->keys.clear();
+            misses->checks.clear();
+
+            for (TreeNode *node : nodes)
+            {
+                if (node == nullptr)
+                {
+                    continue;
+                }
+
+                const std::uint64_t key = node->state().hash();
+                const std::uint64_t check = node->state().hash(CHECK_SEED);
+                auto it = index_.find(key);
+                if (it == index_.end() || entries_[it->second].check != check)
+                {
+                    misses->nodes.push_back(node);
+                    misses->keys.push_back(key);
+                    misses->checks.push_back(check);
+                    continue;
+                }
+
+                ++hits_;
+                Entry &entry = entries_[it->second];
+                entry.referenced = true;
+                StateEvaluation &evaluation = node->evaluation();
+                evaluation.setValue(entry.value);
+                std::vector<float> &policy = evaluation.getPolicy();
+                std::copy_n(entry.policy.begin(), std::min(policy.size(), entry.policy.size()), policy.begin());
+            }
+            misses_ += misses->nodes.size();
+
+            if (misses->nodes.empty())
+            {
+                spare_misses_.push_back(std::move(misses));
+                return;
+            }
+        }
+
+        // Only the uncached rows reach the model.
+        evaluator_(misses->nodes);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t i = 0; i < misses->nodes.size(); ++i)
+        {
+            const std::uint64_t key = misses->keys[i];
+            auto it = index_.find(key);
+            if (it != index_.end())
+            {
+                // Another thread may have cached the same position in the meantime; a
+                // different position under the same key takes over its entry.
+                Entry &entry = entries_[it->second];
+                if (entry.check != misses->checks[i])
+                {
+                    entry.check = misses->checks[i];
+                    fill(entry, misses->nodes[i]->evaluation());
+                }
+                continue;
+            }
+
+            const size_t slot = allocateSlot();
+            Entry &entry = entries_[slot];
+            entry.key = key;
+            entry.check = misses->checks[i];
+            fill(entry, misses->nodes[i]->evaluation());
+            index_.emplace(entry.key, static_cast<std::uint32_t>(slot));
+        }
+        spare_misses_.push_back(std::move(misses));
+    }
+
+    void EvaluationCache::fill(Entry &entry, const StateEvaluation &evaluation)
+    {
+        entry.value = evaluation.getValue();
+        const std::vector<float> &policy = evaluation.getPolicy();
+        entry.policy.fill(0.0f);
+        std::copy_n(policy.begin(), std::min(policy.size(), entry.policy.size()), entry.policy.begin());
+        entry.referenced = false;
+    }
+
+    size_t EvaluationCache::allocateSlot()
+    {
+        if (entries_.size() < capacity_)
+        {
+            entries_.emplace_back();
+            return entries_.size() - 1;
+        }
+
+        // CLOCK: sweep the hand, giving referenced entries a second chance.
+        while (entries_[clock_hand_].referenced)
+        {
+            entries_[clock_hand_].referenced = false;
+            clock_hand_ = (clock_hand_ + 1) % capacity_;
+        }
+        const size_t victim = clock_hand_;
+        clock_hand_ = (clock_hand_ + 1) % capacity_;
+        index_.erase(entries_[victim].key);
+        return victim;
+    }
+
+    std::uint64_t EvaluationCache::getHits() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return hits_;
+    }
+
+    std::uint64_t EvaluationCache::getMisses() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return misses_;
+    }
+
+    size_t EvaluationCache::size() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return index_.size();
+    }
+
+} // namespace scout
@@ -0,0 +1,106 @@
+#ifndef WASM_SCOUT_LIB_EVALUATION_CACHE_H
+#define WASM_SCOUT_LIB_EVALUATION_CACHE_H
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "lib/game.h"
+#include "lib/mcts.h"
+
+namespace scout
+{
+
+    /**
+     * @brief A bounded, thread-safe cache of evaluations in front of another Evaluator.
+     *
+     * Evaluations (value plus the policy over all moves) are keyed by GameState::hash(),
+     * and each entry keeps a second, independently seeded hash of its position as a check
+     * word, so two positions whose keys collide are told apart. Each call fills the cached
+     * nodes directly and forwards only the remaining ones to the wrapped evaluator, as a
+     * single smaller batch, gathered in a buffer reused across calls. When the memory budget is used
+     * up, entries are evicted with the CLOCK (second chance) policy.
+     *
+     * Like OnnxEvaluator, the cache is not copyable; pass it as std::ref(cache). It can
+     * be shared by several threads, provided the wrapped evaluator is itself safe to call
+     * concurrently (e.g. an InferenceServer::evaluator()).
+     */
+    class EvaluationCache
+    {
+    public:
+        /**
+         * @param evaluator The evaluator to run on cache misses.
+         * @param memoryBudgetBytes Upper bound on the memory used by the entries and their index.
+         */
+        EvaluationCache(Evaluator evaluator, size_t memoryBudgetBytes);
+
+        EvaluationCache(const EvaluationCache &) = delete;
+        EvaluationCache &operator=(const EvaluationCache &) = delete;
+
+        // Evaluates `nodes`, running the wrapped evaluator on the uncached ones only.
+        void operator()(const std::vector<TreeNode *> &nodes);
+
+        // Number of nodes served from the cache and forwarded to the wrapped evaluator.
+        std::uint64_t getHits() const;
+        std::uint64_t getMisses() const;
+
+        // Number of cached evaluations, and the most the budget allows.
+        size_t size() const;
+        size_t capacity() const { return capacity_; }
+
+        // Approximate memory taken by one cached evaluation, index included.
+        static constexpr size_t bytesPerEntry();
+
+    private:
+        // The seed of the entries' check word.
+        static constexpr std::uint64_t CHECK_SEED = 0x9e3779b97f4a7c15ULL;
+
+        struct Entry
+        {
+            std::uint64_t key = 0;
+            std::uint64_t check = 0;
+            float value = 0.0f;
+            std::array<float, GameState::NUM_MOVES> policy{};
+            // The CLOCK reference bit, set on every hit.
+            bool referenced = false;
+        };
+
+        // The nodes of one call that missed the cache, and their keys and check words.
+        struct Misses
+        {
+            std::vector<TreeNode *> nodes;
+            std::vector<std::uint64_t> keys;
+            std::vector<std::uint64_t> checks;
+        };
+
+        // Returns the slot for a new entry, evicting an old one if the cache is full.
+        size_t allocateSlot();
+
+        // Copies a node's evaluation into `entry`.
+        static void fill(Entry &entry, const StateEvaluation &evaluation);
+
+        Evaluator evaluator_;
+        const size_t capacity_;
+
+        mutable std::mutex mutex_;
+        std::vector<Entry> entries_;
+        std::unordered_map<std::uint64_t, std::uint32_t> index_;
+        size_t clock_hand_ = 0;
+        // Miss buffers of finished calls, one per call that ran at the same time.
+        std::vector<std::unique_ptr<Misses>> spare_misses_;
+        std::uint64_t hits_ = 0;
+        std::uint64_t misses_ = 0;
+    };
+
+    constexpr size_t EvaluationCache::bytesPerEntry()
+    {
+        // An index node holds the key, the slot and roughly two pointers of bookkeeping.
+        return sizeof(Entry) + sizeof(std::uint64_t) + sizeof(std::uint32_t) + 2 * sizeof(void *);
+    }
+
+} // namespace scout
+
+#endif // WASM_SCOUT_LIB_EVALUATION_CACHE_H
@@ -0,0 +1,147 @@
+#include "lib/evaluation_cache.h"
+
+#include <memory>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+namespace scout
+{
+
+    namespace
+    {
+        // Gives every node a value derived from its hash, and records the batch sizes.
+        class RecordingEvaluator
+        {
+        public:
+            void operator()(const std::vector<TreeNode *> &nodes)
+            {
+                batches.push_back(nodes.size());
+                for (TreeNode *node : nodes)
+                {
+                    node->evaluation().setValue(static_cast<float>(node->state().hash() % 1000) / 1000.0f);
+                    node->evaluation().getPolicy()[1] = 0.5f;
+                }
+            }
+
+            std::vector<size_t> batches;
+        };
+
+        std::vector<std::unique_ptr<TreeNode>> childrenOf(const GameState &state)
+        {
+            std::vector<std::unique_ptr<TreeNode>> children;
+            for (int move = 0; move < GameState::NUM_MOVES; ++move)
+            {
+                if (state.isMoveAllowed(move))
+                {
+                    children.push_back(std::make_unique<TreeNode>(state.move(move), GameState::NUM_MOVES));
+                }
+            }
+            return children;
+        }
+
+        std::vector<TreeNode *> pointers(const std::vector<std::unique_ptr<TreeNode>> &nodes)
+        {
+            std::vector<TreeNode *> result;
+            for (const auto &node : nodes)
+            {
+                result.push_back(node.get());
+            }
+            return result;
+        }
+    }
+
+    TEST(EvaluationCacheTest, ForwardsOnlyMisses)
+    {
+        RecordingEvaluator recording;
+        EvaluationCache cache(std::ref(recording), 1 << 20);
+
+        auto first = childrenOf(GameState());
+        cache(pointers(first));
+        EXPECT_EQ(cache.getHits(), 0u);
+        EXPECT_EQ(cache.getMisses(), first.size());
+        EXPECT_EQ(cache.size(), first.size());
+
+        // The same positions again, plus one new one, with a nullptr row in between.
+        auto second = childrenOf(GameState());
+        auto batch = pointers(second);
+        batch.push_back(nullptr);
+        TreeNode fresh(GameState().move(0)->move(0), GameState::NUM_MOVES);
+        batch.push_back(&fresh);
+        cache(batch);
+
+        EXPECT_EQ(cache.getHits(), second.size());
+        EXPECT_EQ(cache.getMisses(), first.size() + 1);
+        ASSERT_EQ(recording.batches.size(), 2u);
+        EXPECT_EQ(recording.batches[1], 1u);
+
+        for (size_t i = 0; i < second.size(); ++i)
+        {
+            EXPECT_EQ(second[i]->evaluation(), first[i]->evaluation());
+        }
+    }
+
+    TEST(EvaluationCacheTest, EvictsWithinBudget)
+    {
+        RecordingEvaluator recording;
+        EvaluationCache cache(std::ref(recording), 4 * EvaluationCache::bytesPerEntry());
+        EXPECT_EQ(cache.capacity(), 4u);
+
+        auto children = childrenOf(GameState());
+        ASSERT_EQ(children.size(), 9u);
+
+        cache(pointers(children));
+        EXPECT_EQ(cache.size(), 4u);
+
+        // The most recent entry is still cached; a hit sets its reference bit.
+        TreeNode last(GameState().move(8), GameState::NUM_MOVES);
+        cache({&last});
+        EXPECT_EQ(cache.getHits(), 1u);
+
+        // Inserting three more entries evicts every other one first.
+        std::vector<std::unique_ptr<TreeNode>> others;
+        for (int move = 0; move < 3; ++move)
+        {
+            others.push_back(std::make_unique<TreeNode>(GameState().move(0)->move(move), GameState::NUM_MOVES));
+        }
+        cache(pointers(others));
+        EXPECT_EQ(cache.size(), 4u);
+
+        TreeNode again(GameState().move(8), GameState::NUM_MOVES);
+        cache({&again});
+        EXPECT_EQ(cache.getHits(), 2u);
+    }
+
+    TEST(EvaluationCacheTest, RejectsTinyBudget)
+    {
+        EXPECT_THROW(EvaluationCache(ZeroValueUniformEvaluator(GameState::NUM_MOVES), 1), std::invalid_argument);
+    }
+
+    TEST(EvaluationCacheTest, SharedBetweenSearchThreads)
+    {
+        // ZeroValueUniformEvaluator is stateless, so it may run on several threads at once.
+        EvaluationCache cache(ZeroValueUniformEvaluator(GameState::NUM_MOVES), 1 << 20);
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+        {
+            threads.emplace_back([&cache, t]
+                                 {
+                PredictiveUpperConfidenceBound pucb_strategy(t);
+                MonteCarloTreeSearch mcts(std::ref(pucb_strategy), std::ref(cache));
+                TreeNode root(std::make_unique<GameState>(), GameState::NUM_MOVES);
+                for (int i = 0; i < 300; ++i)
+                {
+                    mcts.expand(&root);
+                } });
+        }
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+
+        EXPECT_GT(cache.getHits(), 0u);
+        EXPECT_LE(cache.size(), cache.getMisses());
+    }
+
+} // namespace scout
@@ -0,0 +1,247 @@
+#include "lib/evaluation_table.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include "lib/float16.h"
+
+namespace scout
+{
+
+    namespace
+    {
+        std::uint64_t half(float value, int position)
+        {
+            return static_cast<std::uint64_t>(toFloat16(value)) << (16 * position);
+        }
+
+        float unhalf(std::uint64_t word, int position)
+        {
+            return fromFloat16(static_cast<std::uint16_t>(word >> (16 * position)));
+        }
+    }
+
+    EvaluationTable::EvaluationTable(size_t memoryBudgetBytes)
+    {
+        if (memoryBudgetBytes < sizeof(Bucket))
+        {
+            throw std::invalid_argument("Memory budget is too small for an evaluation table.");
+        }
+        size_t buckets = 1;
+        while (buckets * 2 * sizeof(Bucket) <= memoryBudgetBytes)
+        {
+            buckets *= 2;
+        }
+        buckets_ = std::make_unique<Bucket[]>(buckets);
+        mask_ = buckets - 1;
+    }
+
+    bool EvaluationTable::load(const Slot &slot, std::uint64_t &key, std::uint64_t (&data)[3])
+    {
+        // data[2] carries the sequence number: it is read before the other words and again
+        // after them, and the read only counts if it was even and did not change.
+        data[2] = slot.data[2].load(std::memory_order_acquire);
+        if ((data[2] >> SEQUENCE_SHIFT) == 0 || (data[2] & SEQUENCE_ONE) != 0)
+        {
+            return false;
+        }
+        key = slot.key.load(std::memory_order_relaxed);
+        data[0] = slot.data[0].load(std::memory_order_relaxed);
+        data[1] = slot.data[1].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return slot.data[2].load(std::memory_order_relaxed) == data[2];
+    }
+
+    EvaluationTable::Entry EvaluationTable::unpack(const std::uint64_t (&data)[3])
+    {
+        Entry entry;
+        entry.value = unhalf(data[0], 0);
+        for (int move = 0; move < GameState::NUM_MOVES; ++move)
+        {
+            const int position = move + 1;
+            entry.policy[move] = unhalf(data[position / 4], position % 4);
+        }
+        entry.generation = static_cast<std::uint8_t>(data[2] >> GENERATION_SHIFT);
+        return entry;
+    }
+
+    bool EvaluationTable::probe(std::uint64_t key, Entry &entry) const
+    {
+        for (const Slot &slot : bucketOf(key).slots)
+        {
+            std::uint64_t stored_key;
+            std::uint64_t data[3];
+            if (load(slot, stored_key, data) && stored_key == key)
+            {
+                entry = unpack(data);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void EvaluationTable::store(std::uint64_t key, float value, const std::vector<float> &policy)
+    {
+        const std::uint8_t generation = getGeneration();
+
+        // The key's own slot, else an empty one, else the oldest one.
+        Bucket &bucket = bucketOf(key);
+        Slot *target = nullptr;
+        int ages[PROBE_LENGTH];
+        for (int i = 0; i < PROBE_LENGTH && target == nullptr; ++i)
+        {
+            std::uint64_t stored_key;
+            std::uint64_t data[3];
+            const std::uint64_t last = bucket.slots[i].data[2].load(std::memory_order_relaxed);
+            if ((last >> SEQUENCE_SHIFT) == 0 || (load(bucket.slots[i], stored_key, data) && stored_key == key))
+            {
+                target = &bucket.slots[i];
+            }
+            // A slot being written counts as new, so that it is replaced last.
+            const bool writing = (last & SEQUENCE_ONE) != 0;
+            ages[i] = writing ? 0 : static_cast<std::uint8_t>(generation - static_cast<std::uint8_t>(last >> GENERATION_SHIFT));
+        }
+
+        const bool replacing = target == nullptr;
+        if (replacing)
+        {
+            // Among equally old slots, the key's high bits (the low ones chose the bucket)
+            // pick where the search starts, so that no slot is always the one to go.
+            const int first = static_cast<int>((key >> 32) % PROBE_LENGTH);
+            int oldest = -1;
+            for (int i = 0; i < PROBE_LENGTH; ++i)
+            {
+                const int slot = (first + i) % PROBE_LENGTH;
+                if (ages[slot] > oldest)
+                {
+                    target = &bucket.slots[slot];
+                    oldest = ages[slot];
+                }
+            }
+        }
+
+        std::uint64_t data[3] = {half(value, 0), 0, 0};
+        for (int move = 0; move < GameState::NUM_MOVES && move < static_cast<int>(policy.size()); ++move)
+        {
+            const int position = move + 1;
+            data[position / 4] |= half(policy[move], position % 4);
+        }
+        data[2] |= static_cast<std::uint64_t>(generation) << GENERATION_SHIFT;
+
+        // Claim the slot by making its sequence number odd. If another store holds it, or
+        // takes it first, this one is dropped: the table is a cache, and nobody waits.
+        std::uint64_t claimed = target->data[2].load(std::memory_order_relaxed);
+        if ((claimed & SEQUENCE_ONE) != 0 ||
+            !target->data[2].compare_exchange_strong(claimed, claimed + SEQUENCE_ONE, std::memory_order_relaxed))
+        {
+            return;
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        target->key.store(key, std::memory_order_relaxed);
+        target->data[0].store(data[0], std::memory_order_relaxed);
+        target->data[1].store(data[1], std::memory_order_relaxed);
+        // The sequence number ends even, and skips the 0 of an empty slot when it wraps.
+        std::uint64_t sequence = (claimed >> SEQUENCE_SHIFT) + 2;
+        sequence &= (std::uint64_t{1} << (64 - SEQUENCE_SHIFT)) - 1;
+        sequence += sequence == 0 ? 2 : 0;
+        target->data[2].store(data[2] | sequence << SEQUENCE_SHIFT, std::memory_order_release);
+
+        if (replacing)
+        {
+            replacements_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void EvaluationTable::clear()
+    {
+        for (size_t i = 0; i <= mask_; ++i)
+        {
+            for (Slot &slot : buckets_[i].slots)
+            {
+                slot.key.store(0, std::memory_order_relaxed);
+                for (auto &word : slot.data)
+                {
+                    word.store(0, std::memory_order_relaxed);
+                }
+            }
+        }
+    }
+
+    Evaluator EvaluationTable::evaluator(Evaluator evaluator)
+    {
+        auto wrapper = std::make_shared<Wrapper>();
+        wrapper->evaluator = std::move(evaluator);
+        {
+            std::lock_guard<std::mutex> lock(wrappers_mutex_);
+            wrappers_.push_back(wrapper);
+        }
+        return [this, wrapper](const std::vector<TreeNode *> &nodes)
+        { evaluate(*wrapper, nodes); };
+    }
+
+    void EvaluationTable::evaluate(Wrapper &wrapper, const std::vector<TreeNode *> &nodes)
+    {
+        std::vector<TreeNode *> &misses = wrapper.misses;
+        misses.clear();
+        std::uint64_t hits = 0;
+        Entry entry;
+        for (TreeNode *node : nodes)
+        {
+            if (node == nullptr)
+            {
+                continue;
+            }
+            if (!probe(node->state().hash(), entry))
+            {
+                misses.push_back(node);
+                continue;
+            }
+
+            ++hits;
+            StateEvaluation &evaluation = node->evaluation();
+            evaluation.setValue(entry.value);
+            std::vector<float> &policy = evaluation.getPolicy();
+            std::copy_n(entry.policy.begin(), std::min(policy.size(), entry.policy.size()), policy.begin());
+        }
+
+        // Only this thread writes the wrapper's counters, so they need no atomic increment.
+        wrapper.hits.store(wrapper.hits.load(std::memory_order_relaxed) + hits, std::memory_order_relaxed);
+        wrapper.missed.store(wrapper.missed.load(std::memory_order_relaxed) + misses.size(), std::memory_order_relaxed);
+        if (misses.empty())
+        {
+            return;
+        }
+
+        // Only the unstored rows reach the model.
+        wrapper.evaluator(misses);
+        for (TreeNode *node : misses)
+        {
+            const StateEvaluation &evaluation = node->evaluation();
+            store(node->state().hash(), evaluation.getValue(), evaluation.getPolicy());
+        }
+    }
+
+    std::uint64_t EvaluationTable::getHits() const
+    {
+        std::lock_guard<std::mutex> lock(wrappers_mutex_);
+        std::uint64_t hits = 0;
+        for (const auto &wrapper : wrappers_)
+        {
+            hits += wrapper->hits.load(std::memory_order_relaxed);
+        }
+        return hits;
+    }
+
+    std::uint64_t EvaluationTable::getMisses() const
+    {
+        std::lock_guard<std::mutex> lock(wrappers_mutex_);
+        std::uint64_t misses = 0;
+        for (const auto &wrapper : wrappers_)
+        {
+            misses += wrapper->missed.load(std::memory_order_relaxed);
+        }
+        return misses;
+    }
+
+} // namespace scout
@@ -0,0 +1,139 @@
+#ifndef WASM_SCOUT_LIB_EVALUATION_TABLE_H
+#define WASM_SCOUT_LIB_EVALUATION_TABLE_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "lib/game.h"
+#include "lib/mcts.h"
+
+namespace scout
+{
+
+    /**
+     * @brief A fixed-size, lock-free hash table of evaluations keyed by GameState::hash(),
+     * for sharing between search threads and self-play workers without a mutex.
+     *
+     * Each slot is four 64-bit words: the key, then the value and the policy in fp16, the
+     * generation it was stored in and a sequence number. Each slot is a seqlock: a store
+     * claims the slot by making the sequence number odd, writes the words and makes it
+     * even again, and a probe that sees an odd or changed sequence number counts as a
+     * miss. Nobody waits: a store that finds the slot claimed by another thread is
+     * dropped. So a probe returns an entry exactly as it was stored or nothing, and any
+     * key, 0 included, can be stored.
+     *
+     * Slots are open-addressed within buckets of PROBE_LENGTH slots, aligned to 128 bytes,
+     * so a probe reads two cache lines. A store takes the key's own slot or an empty one,
+     * and otherwise replaces the slot stored the most generations ago; among slots of the
+     * same age, the key's high bits pick which one goes, so no slot is always the victim.
+     */
+    class EvaluationTable
+    {
+    public:
+        static constexpr int PROBE_LENGTH = 4;
+        static constexpr size_t BYTES_PER_SLOT = 4 * sizeof(std::uint64_t);
+
+        // An entry as read back from the table.
+        struct Entry
+        {
+            float value = 0.0f;
+            std::array<float, GameState::NUM_MOVES> policy{};
+            std::uint8_t generation = 0;
+        };
+
+        // Rounds `memoryBudgetBytes` down to a power of two number of buckets; throws
+        // std::invalid_argument if that is less than one bucket.
+        explicit EvaluationTable(size_t memoryBudgetBytes);
+
+        EvaluationTable(const EvaluationTable &) = delete;
+        EvaluationTable &operator=(const EvaluationTable &) = delete;
+
+        // Copies the entry for `key` to `entry` and returns true, or returns false.
+        bool probe(std::uint64_t key, Entry &entry) const;
+
+        // Stores an evaluation under `key`, stamped with the current generation. The store
+        // is dropped if another thread is writing the slot it chose at the same time.
+        void store(std::uint64_t key, float value, const std::vector<float> &policy);
+
+        // Starts a new generation (e.g. once per move), which ages every stored entry.
+        void newGeneration() { generation_.fetch_add(1, std::memory_order_relaxed); }
+        std::uint8_t getGeneration() const { return generation_.load(std::memory_order_relaxed); }
+
+        // Forgets every entry. Not safe to call while other threads use the table.
+        void clear();
+
+        size_t capacity() const { return (mask_ + 1) * PROBE_LENGTH; }
+
+        /**
+         * @brief An Evaluator that serves nodes from the table and forwards only the
+         * misses to `evaluator`, as one smaller batch, then stores their evaluations.
+         *
+         * Every thread wraps its own evaluator around the same table. The returned
+         * evaluator, and its copies, must be used by one thread at a time: it reuses one
+         * buffer for the misses and counts its hits and misses in counters of its own.
+         */
+        Evaluator evaluator(Evaluator evaluator);
+
+        // Nodes that the evaluator() wrappers served from the table and forwarded, summed
+        // over the wrappers, and entries replaced by another key. probe() counts nothing, and each wrapper
+        // only writes its own counters, so lookups never write to a shared cache line.
+        std::uint64_t getHits() const;
+        std::uint64_t getMisses() const;
+        std::uint64_t getReplacements() const { return replacements_.load(std::memory_order_relaxed); }
+
+    private:
+        struct Slot
+        {
+            std::atomic<std::uint64_t> key{0};
+            // Value and policy[0..2]; policy[3..6]; policy[7..8], the generation in bits
+            // 32-39 and the sequence number in the top 24 bits, which is 0 in an empty slot.
+            std::atomic<std::uint64_t> data[3] = {};
+        };
+
+        static constexpr int GENERATION_SHIFT = 32;
+        static constexpr int SEQUENCE_SHIFT = 40;
+        static constexpr std::uint64_t SEQUENCE_ONE = std::uint64_t{1} << SEQUENCE_SHIFT;
+
+        struct alignas(PROBE_LENGTH * BYTES_PER_SLOT) Bucket
+        {
+            Slot slots[PROBE_LENGTH];
+        };
+
+        // The state of one evaluator() wrapper, on a cache line of its own. Only the
+        // wrapper's thread writes the counters; getHits() and getMisses() read them.
+        struct alignas(64) Wrapper
+        {
+            Evaluator evaluator;
+            std::vector<TreeNode *> misses;
+            std::atomic<std::uint64_t> hits{0};
+            std::atomic<std::uint64_t> missed{0};
+        };
+
+        // Reads the slot's four words; false if the slot is empty or being written.
+        static bool load(const Slot &slot, std::uint64_t &key, std::uint64_t (&data)[3]);
+        static Entry unpack(const std::uint64_t (&data)[3]);
+
+        const Bucket &bucketOf(std::uint64_t key) const { return buckets_[key & mask_]; }
+        Bucket &bucketOf(std::uint64_t key) { return buckets_[key & mask_]; }
+
+        // Serves `nodes` through `wrapper`, as the evaluators returned by evaluator() do.
+        void evaluate(Wrapper &wrapper, const std::vector<TreeNode *> &nodes);
+
+        std::unique_ptr<Bucket[]> buckets_;
+        size_t mask_;
+        std::atomic<std::uint8_t> generation_{0};
+
+        std::atomic<std::uint64_t> replacements_{0};
+
+        // Every wrapper handed out, for summing their counters.
+        mutable std::mutex wrappers_mutex_;
+        std::vector<std::shared_ptr<Wrapper>> wrappers_;
+    };
+
+} // namespace scout
+
+#endif // WASM_SCOUT_LIB_EVALUATION_TABLE_H
@@ -0,0 +1,198 @@
+#include "lib/evaluation_table.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+namespace scout
+{
+
+    namespace
+    {
+        // Gives every node a value derived from its hash, and records the batch sizes.
+        class RecordingEvaluator
+        {
+        public:
+            void operator()(const std::vector<TreeNode *> &nodes)
+            {
+                batches.push_back(nodes.size());
+                for (TreeNode *node : nodes)
+                {
+                    node->evaluation().setValue(static_cast<float>(node->state().hash() % 1000) / 1000.0f);
+                    node->evaluation().getPolicy()[1] = 0.5f;
+                }
+            }
+
+            std::vector<size_t> batches;
+        };
+
+        std::vector<float> uniformPolicy(float prior)
+        {
+            return std::vector<float>(GameState::NUM_MOVES, prior);
+        }
+    }
+
+    TEST(EvaluationTableTest, StoresEvaluationsInHalfPrecision)
+    {
+        EvaluationTable table(1 << 16);
+        EXPECT_EQ(table.capacity(), (1u << 16) / EvaluationTable::BYTES_PER_SLOT);
+
+        std::vector<float> policy = uniformPolicy(0.0f);
+        policy[2] = 0.3f;
+        policy[8] = 0.7f;
+        table.store(42, -0.25f, policy);
+
+        EvaluationTable::Entry entry;
+        ASSERT_TRUE(table.probe(42, entry));
+        EXPECT_EQ(entry.value, -0.25f);
+        EXPECT_NEAR(entry.policy[2], 0.3f, 1e-3f);
+        EXPECT_NEAR(entry.policy[8], 0.7f, 1e-3f);
+        EXPECT_EQ(entry.policy[0], 0.0f);
+        EXPECT_EQ(entry.generation, 0);
+
+        EXPECT_FALSE(table.probe(43, entry));
+
+        // Storing the key again overwrites its entry in place.
+        table.store(42, 0.5f, policy);
+        ASSERT_TRUE(table.probe(42, entry));
+        EXPECT_EQ(entry.value, 0.5f);
+        EXPECT_EQ(table.getReplacements(), 0u);
+
+        table.clear();
+        EXPECT_FALSE(table.probe(42, entry));
+
+        // An all-zero entry under key 0 is still an entry, not an empty slot.
+        EXPECT_FALSE(table.probe(0, entry));
+        table.store(0, 0.0f, uniformPolicy(0.0f));
+        ASSERT_TRUE(table.probe(0, entry));
+        EXPECT_EQ(entry.value, 0.0f);
+        EXPECT_EQ(entry.policy[4], 0.0f);
+    }
+
+    TEST(EvaluationTableTest, ReplacesTheOldestEntries)
+    {
+        // A single bucket: every key competes for the same four slots.
+        EvaluationTable table(EvaluationTable::PROBE_LENGTH * EvaluationTable::BYTES_PER_SLOT);
+        ASSERT_EQ(table.capacity(), static_cast<size_t>(EvaluationTable::PROBE_LENGTH));
+
+        const std::vector<float> policy = uniformPolicy(1.0f / GameState::NUM_MOVES);
+        table.store(1, 0.0f, policy);
+        table.store(2, 0.0f, policy);
+        table.newGeneration();
+        table.store(3, 0.0f, policy);
+        table.store(4, 0.0f, policy);
+
+        // The older entries go first.
+        EvaluationTable::Entry entry;
+        table.store(5, 0.0f, policy);
+        EXPECT_NE(table.probe(1, entry), table.probe(2, entry));
+        table.store(6, 0.0f, policy);
+        EXPECT_FALSE(table.probe(1, entry));
+        EXPECT_FALSE(table.probe(2, entry));
+
+        // Within one generation, the keys' high bits spread the replacements over all
+        // slots, instead of one slot taking every new key.
+        for (std::uint64_t key = 7; key < 15; ++key)
+        {
+            const std::uint64_t spread = key << 32 | key;
+            table.store(spread, 0.0f, policy);
+            ASSERT_TRUE(table.probe(spread, entry));
+            EXPECT_EQ(entry.generation, 1);
+        }
+        for (std::uint64_t key : {3, 4, 5, 6})
+        {
+            EXPECT_FALSE(table.probe(key, entry));
+        }
+        EXPECT_EQ(table.getReplacements(), 10u);
+    }
+
+    TEST(EvaluationTableTest, TornWritesReadAsMisses)
+    {
+        // Few slots and many threads storing different evaluations under the same keys.
+        EvaluationTable table(16 * EvaluationTable::BYTES_PER_SLOT);
+        std::atomic<bool> done{false};
+        std::atomic<int> inconsistent{0};
+        std::atomic<int> hits{0};
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 2; ++t)
+        {
+            threads.emplace_back([&table, t]
+                                 {
+                for (int i = 0; i < 200000; ++i)
+                {
+                    // Each entry is internally consistent: every prior equals the value.
+                    const float value = static_cast<float>((i + t * 7) % 100) / 100.0f;
+                    table.store(i % 32, value, uniformPolicy(value));
+                } });
+        }
+        threads.emplace_back([&]
+                             {
+            EvaluationTable::Entry entry;
+            while (!done.load())
+            {
+                for (std::uint64_t key = 0; key < 32; ++key)
+                {
+                    if (!table.probe(key, entry))
+                    {
+                        continue;
+                    }
+                    ++hits;
+                    for (float prior : entry.policy)
+                    {
+                        if (prior != entry.value)
+                        {
+                            ++inconsistent;
+                        }
+                    }
+                }
+            } });
+
+        threads[0].join();
+        threads[1].join();
+        done = true;
+        threads[2].join();
+
+        EXPECT_GT(hits.load(), 0);
+        EXPECT_EQ(inconsistent.load(), 0);
+    }
+
+    TEST(EvaluationTableTest, EvaluatorForwardsOnlyMisses)
+    {
+        RecordingEvaluator recording;
+        EvaluationTable table(1 << 16);
+        Evaluator evaluator = table.evaluator(std::ref(recording));
+
+        std::vector<std::unique_ptr<TreeNode>> first;
+        std::vector<std::unique_ptr<TreeNode>> second;
+        std::vector<TreeNode *> first_batch;
+        std::vector<TreeNode *> second_batch = {nullptr};
+        for (int move = 0; move < GameState::NUM_MOVES; ++move)
+        {
+            first.push_back(std::make_unique<TreeNode>(GameState().move(move), GameState::NUM_MOVES));
+            second.push_back(std::make_unique<TreeNode>(GameState().move(move), GameState::NUM_MOVES));
+            first_batch.push_back(first.back().get());
+            second_batch.push_back(second.back().get());
+        }
+        TreeNode fresh(GameState().move(0)->move(0), GameState::NUM_MOVES);
+        second_batch.push_back(&fresh);
+
+        evaluator(first_batch);
+        evaluator(second_batch);
+
+        ASSERT_EQ(recording.batches.size(), 2u);
+        EXPECT_EQ(recording.batches[1], 1u);
+        EXPECT_EQ(table.getHits(), first.size());
+        EXPECT_EQ(table.getMisses(), first.size() + 1);
+        for (size_t i = 0; i < first.size(); ++i)
+        {
+            const StateEvaluation &original = first[i]->evaluation();
+            const StateEvaluation &cached = second[i]->evaluation();
+            EXPECT_NEAR(cached.getValue(), original.getValue(), 1e-3f);
+            EXPECT_EQ(cached.getPolicy()[1], 0.5f);
+        }
+    }
+
+} // namespace scout
@@ -0,0 +1,102 @@
+#ifndef WASM_SCOUT_LIB_FLOAT16_H
+#define WASM_SCOUT_LIB_FLOAT16_H
+
+#include <cstdint>
+#include <cstring>
+
+namespace scout
+{
+
+    /**
+     * @brief Converts a float to IEEE 754 binary16 bits, rounding to nearest even.
+     *
+     * Written with integer operations only, so it behaves the same in WebAssembly as on
+     * hosts with hardware conversions. Priors and values in [-1, 1] keep about three
+     * decimal digits; magnitudes below 2^-24 flush to zero and above 65504 to infinity.
+     */
+    inline std::uint16_t toFloat16(float value)
+    {
+        std::uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        const std::uint32_t sign = (bits >> 16) & 0x8000u;
+        const std::uint32_t magnitude = bits & 0x7fffffffu;
+
+        if (magnitude >= 0x7f800000u)
+        {
+            // Infinity stays infinity; a NaN keeps a set mantissa bit.
+            return static_cast<std::uint16_t>(sign | 0x7c00u | (magnitude > 0x7f800000u ? 0x0200u : 0u));
+        }
+        if (magnitude >= 0x477ff000u)
+        {
+            // Rounds to a value beyond the largest half.
+            return static_cast<std::uint16_t>(sign | 0x7c00u);
+        }
+        if (magnitude < 0x38800000u)
+        {
+            // Subnormal half: shift the mantissa, with its implicit bit, into place.
+            if (magnitude < 0x33000000u)
+            {
+                return static_cast<std::uint16_t>(sign);
+            }
+            const int shift = 126 - static_cast<int>(magnitude >> 23);
+            const std::uint32_t mantissa = (magnitude & 0x007fffffu) | 0x00800000u;
+            std::uint32_t half = mantissa >> shift;
+            const std::uint32_t rest = mantissa & ((1u << shift) - 1);
+            const std::uint32_t halfway = 1u << (shift - 1);
+            if (rest > halfway || (rest == halfway && (half & 1u) != 0))
+            {
+                ++half;
+            }
+            return static_cast<std::uint16_t>(sign | half);
+        }
+
+        // Normal half: rebias the exponent and round away the low 13 mantissa bits.
+        std::uint32_t half = (magnitude - 0x38000000u) >> 13;
+        const std::uint32_t rest = magnitude & 0x1fffu;
+        if (rest > 0x1000u || (rest == 0x1000u && (half & 1u) != 0))
+        {
+            ++half;
+        }
+        return static_cast<std::uint16_t>(sign | half);
+    }
+
+    // Converts IEEE 754 binary16 bits back to a float; every half is exactly representable.
+    inline float fromFloat16(std::uint16_t half)
+    {
+        const std::uint32_t sign = static_cast<std::uint32_t>(half & 0x8000u) << 16;
+        const std::uint32_t exponent = (half >> 10) & 0x1fu;
+        std::uint32_t mantissa = half & 0x03ffu;
+        std::uint32_t bits;
+
+        if (exponent == 0x1fu)
+        {
+            bits = sign | 0x7f800000u | (mantissa << 13);
+        }
+        else if (exponent != 0)
+        {
+            bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+        }
+        else if (mantissa == 0)
+        {
+            bits = sign;
+        }
+        else
+        {
+            // Subnormal half: normalize the mantissa for the float exponent.
+            int shift = 0;
+            while ((mantissa & 0x0400u) == 0)
+            {
+                mantissa <<= 1;
+                ++shift;
+            }
+            bits = sign | (static_cast<std::uint32_t>(113 - shift) << 23) | ((mantissa & 0x03ffu) << 13);
+        }
+
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+} // namespace scout
+
+#endif // WASM_SCOUT_LIB_FLOAT16_H
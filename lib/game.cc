@@ -160,6 +160,11 @@ namespace scout
     // --- Public Game Logic ---
 
     std::unique_ptr<GameState> GameState::move(int move) const
+    {
+        return std::make_unique<GameState>(afterMove(move));
+    }
+
+    GameState GameState::afterMove(int move) const
     {
         if (!isMoveAllowed(move))
         {
@@ -236,7 +241,7 @@ namespace scout
             currentCell = nextCell(currentCell);
         }
 
-        auto new_state = std::make_unique<GameState>(opponent(_current_player), newScoreOne, newScoreTwo, newSpecialOne, newSpecialTwo, newCells);
+        GameState new_state(opponent(_current_player), newScoreOne, newScoreTwo, newSpecialOne, newSpecialTwo, newCells);
 
         return new_state;
     }
@@ -290,7 +295,14 @@ namespace scout
 
     std::vector<float> GameState::encode() const
     {
-        std::vector<float> encoded(NUM_FEATURES, 0.0f);
+        std::vector<float> encoded(NUM_FEATURES);
+        encodeInto(encoded.data());
+        return encoded;
+    }
+
+    void GameState::encodeInto(float *encoded) const
+    {
+        std::fill_n(encoded, NUM_FEATURES, 0.0f);
 
         if (_current_player == Player::ONE)
         {
@@ -320,16 +332,20 @@ namespace scout
         }
 
         GameStateMoveValuesEstimator estimator;
-        std::vector<float> moveValues = estimator.estimateMoveValues(*this);
-        std::copy(moveValues.begin(), moveValues.end(), encoded.begin() + 38);
-
-        return encoded;
+        estimator.estimateMoveValues(*this, encoded + 38);
     }
 
     std::vector<float> GameStateMoveValuesEstimator::estimateMoveValues(const GameState &state) const
     {
         // Create a vector to hold the estimated value of each move.
         std::vector<float> values(GameState::NUM_MOVES, 0.0f);
+        estimateMoveValues(state, values.data());
+        return values;
+    }
+
+    void GameStateMoveValuesEstimator::estimateMoveValues(const GameState &state, float *values) const
+    {
+        std::fill_n(values, GameState::NUM_MOVES, 0.0f);
 
         // Calculate the score difference from the current player's perspective.
         float parentDiff = (state.getCurrentPlayer() == Player::ONE)
@@ -346,21 +362,59 @@ namespace scout
             }
 
             // Simulate the move to get the resulting "child" game state.
-            auto childState = state.move(i);
+            const GameState childState = state.afterMove(i);
 
             // Calculate the score difference in the new state, still from the original player's perspective.
             float childDiff = (state.getCurrentPlayer() == Player::ONE)
-                                  ? static_cast<float>(childState->getScoreOne() - childState->getScoreTwo())
-                                  : static_cast<float>(childState->getScoreTwo() - childState->getScoreOne());
+                                  ? static_cast<float>(childState.getScoreOne() - childState.getScoreTwo())
+                                  : static_cast<float>(childState.getScoreTwo() - childState.getScoreOne());
 
             // The value of the move is the normalized change in score difference.
             // This rewards moves that increase the player's score advantage.
             values[i] = (childDiff - parentDiff) / 81.0f;
         }
+    }
 
-        return values;
+    namespace
+    {
+        // The splitmix64 finalizer: spreads every input bit over the whole word.
+        std::uint64_t mix(std::uint64_t x)
+        {
+            x ^= x >> 30;
+            x *= 0xbf58476d1ce4e5b9ULL;
+            x ^= x >> 27;
+            x *= 0x94d049bb133111ebULL;
+            x ^= x >> 31;
+            return x;
+        }
     }
 
+    std::uint64_t GameState::hash(std::uint64_t seed) const
+    {
+        std::uint64_t h = mix(seed ^ static_cast<std::uint64_t>(_current_player));
+        h = mix(h ^ static_cast<std::uint64_t>(_score_one));
+        h = mix(h ^ static_cast<std::uint64_t>(_score_two));
+        h = mix(h ^ static_cast<std::uint64_t>(_special_one + 1));
+        h = mix(h ^ static_cast<std::uint64_t>(_special_two + 1));
+        for (int cell : _cells)
+        {
+            h = mix(h ^ static_cast<std::uint64_t>(cell));
+        }
+        return h;
+    }
+
+    bool GameState::operator==(const GameState &other) const
+    {
+        return _current_player == other._current_player &&
+               _score_one == other._score_one &&
+               _score_two == other._score_two &&
+               _special_one == other._special_one &&
+               _special_two == other._special_two &&
+               _cells == other._cells;
+    }
+
+    Outcomes::Outcomes(int first, int second, int ties) : _first(first), _second(second), _ties(ties) {}
+
     float Outcomes::winRateFor(Player player) const
     {
         int total = getTotalOutcomes();
@@ -401,6 +455,19 @@ namespace scout
         return _first + _second + _ties;
     }
 
+    int Outcomes::getCount(Player winner) const
+    {
+        switch (winner)
+        {
+        case Player::ONE:
+            return _first;
+        case Player::TWO:
+            return _second;
+        default:
+            return _ties;
+        }
+    }
+
     std::string Outcomes::toString() const
     {
         std::stringstream ss;
@@ -37,6 +37,9 @@ namespace scout
     {
     public:
         std::vector<float> estimateMoveValues(const GameState &state) const;
+
+        // Writes the GameState::NUM_MOVES move values to `values`, without allocating.
+        void estimateMoveValues(const GameState &state, float *values) const;
     };
 
     class GameState
@@ -63,11 +66,16 @@ namespace scout
         // Game logic
         std::unique_ptr<GameState> move(int move) const;
 
+        // The state after `move`, by value, for callers that store states without allocating.
+        GameState afterMove(int move) const;
+
         bool isMoveAllowed(int move) const;
         bool isGameOver() const { return _is_game_over; }
         Player getCurrentPlayer() const { return _current_player; }
         std::optional<Player> getWinner() const { return _winner; }
         std::vector<float> encode() const;
+        // Writes the NUM_FEATURES features of encode() to `features`, without allocating.
+        void encodeInto(float *features) const;
         int getScoreOne() const { return _score_one; }
         int getScoreTwo() const { return _score_two; }
         int getSpecialOne() const { return _special_one; }
@@ -75,6 +83,13 @@ namespace scout
         std::string toString() const;
         std::vector<int> getCells() const;
 
+        // A 64-bit hash of the position (cells, scores, specials and the player to move).
+        // Other seeds give unrelated hashes of the same position, e.g. for a check word.
+        std::uint64_t hash(std::uint64_t seed = 0) const;
+
+        // Two states are equal when they describe the same position.
+        bool operator==(const GameState &other) const;
+
     private:
         Player _current_player;
         bool _is_game_over;
@@ -102,6 +117,9 @@ namespace scout
     public:
         Outcomes() = default;
 
+        // Restores counts, e.g. from a snapshot.
+        Outcomes(int first, int second, int ties);
+
         /**
          * @brief Calculates the win rate for a given player, where a tie counts as half a win.
          * @param player The player for whom to calculate the win rate.
@@ -115,6 +133,9 @@ namespace scout
         // Returns the total number of games played.
         int getTotalOutcomes() const;
 
+        // Returns how often `winner` won, or the number of ties for Player::NONE.
+        int getCount(Player winner) const;
+
         // Creates a string representation of the object.
         std::string toString() const;
 
@@ -212,6 +212,36 @@ namespace scout
         EXPECT_EQ(stateInverse.getCurrentPlayer(), Player::ONE);
     }
 
+    TEST(GameStateTest, HashAndEqualityIdentifyTranspositions)
+    {
+        GameState root;
+        // Two move orders that reach the same position.
+        auto first = root.move(0)->move(0)->move(0)->move(0)->move(2);
+        auto second = root.move(0)->move(0)->move(2)->move(0)->move(0);
+        auto other = root.move(0)->move(0)->move(0)->move(0)->move(3);
+
+        EXPECT_TRUE(*first == *second);
+        EXPECT_EQ(first->hash(), second->hash());
+
+        EXPECT_FALSE(*first == *other);
+        EXPECT_NE(first->hash(), other->hash());
+        EXPECT_NE(root.hash(), root.move(0)->hash());
+
+        // A seeded hash is just as stable, and unrelated to the default one.
+        EXPECT_EQ(first->hash(7), second->hash(7));
+        EXPECT_NE(first->hash(7), first->hash());
+        EXPECT_NE(first->hash(7), other->hash(7));
+    }
+
+    TEST(GameStateTest, EncodeIntoOverwritesTheRow)
+    {
+        auto state = GameState().move(8)->move(1)->move(7)->move(3);
+        // A row left over from another state must be fully overwritten.
+        std::vector<float> row(GameState::NUM_FEATURES, 7.0f);
+        state->encodeInto(row.data());
+        EXPECT_EQ(row, state->encode());
+    }
+
     // It's good practice to group related tests into a test suite.
     // Here, we create a new suite for the estimator.
     TEST(GameStateMoveValuesEstimatorTest, EstimateMoveValuesForRoot)
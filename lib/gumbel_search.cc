@@ -0,0 +1,253 @@
+#include "lib/gumbel_search.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+namespace scout
+{
+
+    namespace
+    {
+        // Softmax over the legal moves; illegal moves get 0.
+        std::vector<float> softmax(const std::vector<float> &logits, const std::vector<int> &moves)
+        {
+            std::vector<float> result(logits.size(), 0.0f);
+            float max_logit = -std::numeric_limits<float>::infinity();
+            for (int move : moves)
+            {
+                max_logit = std::max(max_logit, logits[move]);
+            }
+            float sum = 0.0f;
+            for (int move : moves)
+            {
+                result[move] = std::exp(logits[move] - max_logit);
+                sum += result[move];
+            }
+            for (int move : moves)
+            {
+                result[move] /= sum;
+            }
+            return result;
+        }
+    }
+
+    GumbelSearch::GumbelSearch(ExpansionStrategy strategy, Evaluator evaluator, std::uint32_t seed,
+                               int maxConsideredMoves)
+        : mcts_(std::move(strategy), evaluator),
+          evaluator_(std::move(evaluator)),
+          random_generator_(seed),
+          max_considered_moves_(maxConsideredMoves)
+    {
+        if (maxConsideredMoves <= 0)
+        {
+            throw std::invalid_argument("At least one root move must be considered.");
+        }
+    }
+
+    SearchResult GumbelSearch::search(const GameState &state, int simulations)
+    {
+        TreeNode root(std::make_unique<GameState>(state), GameState::NUM_MOVES);
+        return search(root, simulations);
+    }
+
+    SearchResult GumbelSearch::search(TreeNode &root, int simulations)
+    {
+        if (root.state().isGameOver())
+        {
+            throw std::invalid_argument("Cannot search a finished game.");
+        }
+        if (simulations <= 0)
+        {
+            throw std::invalid_argument("The search needs at least one simulation.");
+        }
+
+        using Clock = std::chrono::steady_clock;
+        const Clock::time_point start = Clock::now();
+        SearchResult result;
+        mcts_.resetStats();
+
+        // A fresh root was never evaluated as somebody's child, so it has no priors yet.
+        const StateEvaluation &priors = root.evaluation();
+        float prior_sum = 0.0f;
+        for (int move = 0; move < priors.getNumberOfMoves(); ++move)
+        {
+            prior_sum += priors.getPrior(move);
+        }
+        bool evaluated_root = false;
+        if (prior_sum == 0.0f)
+        {
+            evaluator_({&root});
+            evaluated_root = true;
+        }
+        if (!root.isInitialized())
+        {
+            mcts_.expand(&root);
+            ++result.simulations;
+        }
+
+        // Gumbel top-k: sample the moves to consider without replacement.
+        const auto &children = root.getChildStates();
+        std::vector<int> moves;
+        std::vector<float> logits(children.size(), 0.0f);
+        std::vector<float> gumbels(children.size(), 0.0f);
+        std::uniform_real_distribution<float> uniform(std::numeric_limits<float>::min(), 1.0f);
+        for (size_t move = 0; move < children.size(); ++move)
+        {
+            if (children[move] == nullptr)
+            {
+                continue;
+            }
+            moves.push_back(static_cast<int>(move));
+            logits[move] = std::log(std::max(priors.getPrior(move), 1e-8f));
+            gumbels[move] = -std::log(-std::log(uniform(random_generator_)));
+        }
+
+        auto maxVisits = [&children]()
+        {
+            int visits = 0;
+            for (const auto &child : children)
+            {
+                if (child != nullptr)
+                {
+                    visits = std::max(visits, child->getVisits());
+                }
+            }
+            return visits;
+        };
+        // Ranks the considered moves by noise + logit + scaled Q, best first.
+        auto rank = [&](std::vector<int> &considered)
+        {
+            const std::vector<float> q = completedQ(root, logits);
+            const int visits = maxVisits();
+            std::vector<float> score(children.size(), 0.0f);
+            for (int move : considered)
+            {
+                score[move] = gumbels[move] + logits[move] + scaleQ(q[move], visits);
+            }
+            std::stable_sort(considered.begin(), considered.end(), [&score](int a, int b)
+                             { return score[a] > score[b]; });
+        };
+
+        std::vector<int> considered = moves;
+        std::stable_sort(considered.begin(), considered.end(), [&](int a, int b)
+                         { return gumbels[a] + logits[a] > gumbels[b] + logits[b]; });
+        considered.resize(std::min<size_t>(considered.size(), max_considered_moves_));
+
+        // Sequential halving: ceil(log2(m)) phases, each halving the considered moves.
+        const int budget = simulations - result.simulations;
+        const int phases = std::max(1, static_cast<int>(std::ceil(std::log2(considered.size()))));
+        int used = 0;
+        for (int phase = 0; phase < phases && used < budget && !root.isProven(); ++phase)
+        {
+            // The last phase also takes whatever the rounding down left over.
+            const bool last = phase == phases - 1;
+            const int phase_budget = last ? budget - used : budget / phases;
+            const int moves_left = static_cast<int>(considered.size());
+            const int per_move = std::max(1, last ? (phase_budget + moves_left - 1) / moves_left
+                                                  : phase_budget / moves_left);
+            for (int move : considered)
+            {
+                for (int i = 0; i < per_move && used < budget && !root.isProven(); ++i)
+                {
+                    mcts_.expandChild(&root, move);
+                    ++used;
+                }
+            }
+            if (phase < phases - 1)
+            {
+                rank(considered);
+                considered.resize((considered.size() + 1) / 2);
+            }
+        }
+        result.simulations += used;
+
+        rank(considered);
+        result.bestMove = root.isProven() ? root.getBestMove() : considered.front();
+        result.stopReason = root.isProven() ? StopReason::PROVEN : StopReason::SIMULATIONS;
+
+        // The improved policy: softmax(logits + sigma(completed Q)).
+        const std::vector<float> q = completedQ(root, logits);
+        const int visits = maxVisits();
+        std::vector<float> improved_logits(children.size(), 0.0f);
+        for (int move : moves)
+        {
+            improved_logits[move] = logits[move] + scaleQ(q[move], visits);
+        }
+        const std::vector<float> improved = softmax(improved_logits, moves);
+        result.rootStatistics.resize(children.size() + 1);
+        result.rootStatistics[0] = root.getAverageValue().getValue(root.state().getCurrentPlayer());
+        std::copy(improved.begin(), improved.end(), result.rootStatistics.begin() + 1);
+
+        result.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start);
+        result.stats = mcts_.getStats();
+        if (evaluated_root)
+        {
+            result.stats.recordBatch(1);
+        }
+        result.stats.nodes = countNodes(root);
+        result.stats.bytes = countBytes(root);
+        result.stats.elapsed = result.elapsed;
+        return result;
+    }
+
+    std::vector<float> GumbelSearch::completedQ(const TreeNode &root, const std::vector<float> &logits) const
+    {
+        const auto &children = root.getChildStates();
+        const Player player = root.state().getCurrentPlayer();
+
+        std::vector<int> moves;
+        for (size_t move = 0; move < children.size(); ++move)
+        {
+            if (children[move] != nullptr)
+            {
+                moves.push_back(static_cast<int>(move));
+            }
+        }
+        const std::vector<float> prior = softmax(logits, moves);
+
+        // Values are mapped from [-1, 1] to [0, 1].
+        std::vector<float> q(children.size(), 0.0f);
+        int total_visits = 0;
+        float visited_prior = 0.0f;
+        float weighted_q = 0.0f;
+        for (int move : moves)
+        {
+            TreeNode &child = *children[move];
+            if (child.getVisits() == 0)
+            {
+                continue;
+            }
+            q[move] = (child.getAverageValue().getValue(player) + 1.0f) / 2.0f;
+            total_visits += child.getVisits();
+            visited_prior += prior[move];
+            weighted_q += prior[move] * q[move];
+        }
+
+        // Unvisited moves get v_mix, the network value mixed with the visited moves' Q.
+        const float value = (root.evaluation().getValue() + 1.0f) / 2.0f;
+        float mixed_value = value;
+        if (visited_prior > 0.0f)
+        {
+            mixed_value = (value + total_visits * weighted_q / visited_prior) / (1.0f + total_visits);
+        }
+        for (int move : moves)
+        {
+            if (children[move]->getVisits() == 0)
+            {
+                q[move] = mixed_value;
+            }
+        }
+        return q;
+    }
+
+    float GumbelSearch::scaleQ(float q, int maxVisits)
+    {
+        return (C_VISIT + maxVisits) * C_SCALE * q;
+    }
+
+} // namespace scout
@@ -0,0 +1,66 @@
+#ifndef WASM_SCOUT_LIB_GUMBEL_SEARCH_H
+#define WASM_SCOUT_LIB_GUMBEL_SEARCH_H
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "lib/anytime_search.h"
+#include "lib/game.h"
+#include "lib/mcts.h"
+
+namespace scout
+{
+
+    /**
+     * @brief A root search for small simulation budgets, after Gumbel MuZero.
+     *
+     * Instead of PUCT with Dirichlet noise at the root, it samples the root moves to
+     * consider without replacement by adding Gumbel noise to the prior logits (Gumbel
+     * top-k), then splits the budget over them by sequential halving: every phase
+     * gives the remaining moves equal simulations and keeps the better half, ranked by
+     * noise + logit + a scaled Q value. Below the root, the given strategy selects as
+     * usual. The returned policy is the completed-Q improved policy, which assigns
+     * unvisited moves a mixed value estimate instead of ignoring them.
+     */
+    class GumbelSearch
+    {
+    public:
+        /**
+         * @param strategy Selection below the root.
+         * @param seed Seed of the Gumbel noise.
+         * @param maxConsideredMoves How many root moves Gumbel top-k samples.
+         */
+        GumbelSearch(ExpansionStrategy strategy, Evaluator evaluator, std::uint32_t seed,
+                     int maxConsideredMoves = 8);
+
+        // Searches a new tree rooted at `state` with `simulations` simulations.
+        SearchResult search(const GameState &state, int simulations);
+
+        /**
+         * @brief Continues the search of an existing tree.
+         * @return The move chosen by sequential halving (or a proven win) and, as root
+         * statistics, the root value followed by the improved policy.
+         */
+        SearchResult search(TreeNode &root, int simulations);
+
+    private:
+        // The completed Q values of the root moves for the root player, in [0, 1].
+        std::vector<float> completedQ(const TreeNode &root, const std::vector<float> &logits) const;
+
+        // The monotone transformation sigma(q) = (c_visit + max visits) * c_scale * q.
+        static float scaleQ(float q, int maxVisits);
+
+        static constexpr float C_VISIT = 50.0f;
+        static constexpr float C_SCALE = 1.0f;
+
+        MonteCarloTreeSearch mcts_;
+        // Also evaluates a fresh root, for its priors.
+        Evaluator evaluator_;
+        std::mt19937 random_generator_;
+        int max_considered_moves_;
+    };
+
+} // namespace scout
+
+#endif // WASM_SCOUT_LIB_GUMBEL_SEARCH_H
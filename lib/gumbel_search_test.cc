@@ -0,0 +1,76 @@
+#include "lib/gumbel_search.h"
+
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+
+#include "gtest/gtest.h"
+
+namespace scout
+{
+
+    TEST(GumbelSearchTest, SpendsTheWholeBudget)
+    {
+        PredictiveUpperConfidenceBound pucb_strategy(1);
+        GumbelSearch search(std::ref(pucb_strategy), ZeroValueUniformEvaluator(GameState::NUM_MOVES), 1);
+        TreeNode root(std::make_unique<GameState>(), GameState::NUM_MOVES);
+
+        SearchResult result = search.search(root, 200);
+
+        EXPECT_EQ(result.simulations, 200);
+        EXPECT_EQ(root.getVisits(), 200);
+        EXPECT_EQ(result.stopReason, StopReason::SIMULATIONS);
+        ASSERT_EQ(result.rootStatistics.size(), 1u + GameState::NUM_MOVES);
+        EXPECT_NEAR(std::accumulate(result.rootStatistics.begin() + 1, result.rootStatistics.end(), 0.0f), 1.0f, 1e-5);
+        ASSERT_GE(result.bestMove, 0);
+        EXPECT_NE(root.getChildStates()[result.bestMove], nullptr);
+    }
+
+    TEST(GumbelSearchTest, VisitsOnlyTheSampledMoves)
+    {
+        PredictiveUpperConfidenceBound pucb_strategy(1);
+        GumbelSearch search(std::ref(pucb_strategy), ZeroValueUniformEvaluator(GameState::NUM_MOVES), 3, 2);
+        TreeNode root(std::make_unique<GameState>(), GameState::NUM_MOVES);
+
+        SearchResult result = search.search(root, 100);
+
+        int visited_moves = 0;
+        for (const auto &child : root.getChildStates())
+        {
+            visited_moves += child != nullptr && child->getVisits() > 0;
+        }
+        EXPECT_EQ(visited_moves, 2);
+        EXPECT_GT(root.getChildStates()[result.bestMove]->getVisits(), 0);
+    }
+
+    TEST(GumbelSearchTest, SameSeedSameResult)
+    {
+        auto run = [](std::uint32_t seed)
+        {
+            PredictiveUpperConfidenceBound pucb_strategy(1);
+            GumbelSearch search(std::ref(pucb_strategy), ZeroValueUniformEvaluator(GameState::NUM_MOVES), seed);
+            auto state = std::make_unique<GameState>();
+            return search.search(*state->move(8)->move(1)->move(7)->move(3), 300);
+        };
+
+        SearchResult first = run(5);
+        SearchResult second = run(5);
+        EXPECT_EQ(first.bestMove, second.bestMove);
+        EXPECT_EQ(first.rootStatistics, second.rootStatistics);
+    }
+
+    TEST(GumbelSearchTest, PlaysProvenWin)
+    {
+        PredictiveUpperConfidenceBound pucb_strategy(1);
+        GumbelSearch search(std::ref(pucb_strategy), ZeroValueUniformEvaluator(GameState::NUM_MOVES), 1);
+
+        auto state = std::make_unique<GameState>();
+        state = state->move(8)->move(1)->move(7)->move(3)->move(6)->move(3)->move(4)->move(1)->move(8)->move(8);
+        SearchResult result = search.search(*state, 200);
+
+        EXPECT_EQ(result.stopReason, StopReason::PROVEN);
+        EXPECT_EQ(result.bestMove, 8);
+        EXPECT_THROW(search.search(*state, 0), std::invalid_argument);
+    }
+
+} // namespace scout
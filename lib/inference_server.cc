@@ -0,0 +1,150 @@
+#include "lib/inference_server.h"
+
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include <utility>
+
+namespace scout
+{
+
+    InferenceServer::InferenceServer(Evaluator evaluator, int maxBatchSize, std::chrono::microseconds maxWait)
+        : evaluator_(std::move(evaluator)),
+          max_batch_size_(static_cast<size_t>(std::max(1, maxBatchSize))),
+          max_wait_(maxWait),
+          worker_(&InferenceServer::serve, this)
+    {
+    }
+
+    InferenceServer::~InferenceServer()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        ready_.notify_all();
+        worker_.join();
+    }
+
+    std::future<void> InferenceServer::submit(std::vector<TreeNode *> nodes)
+    {
+        Request request;
+        request.nodes = std::move(nodes);
+        request.submitted = std::chrono::steady_clock::now();
+        std::future<void> done = request.done.get_future();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopping_)
+            {
+                throw std::logic_error("Inference server is shutting down.");
+            }
+            queued_rows_ += request.nodes.size();
+            queue_.push_back(std::move(request));
+        }
+        ready_.notify_one();
+        return done;
+    }
+
+    Evaluator InferenceServer::evaluator()
+    {
+        return [this](const std::vector<TreeNode *> &nodes)
+        { submit(nodes).get(); };
+    }
+
+    InferenceServer::Metrics InferenceServer::metrics() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Metrics snapshot = metrics_;
+        snapshot.queueDepth = static_cast<int>(queue_.size());
+        return snapshot;
+    }
+
+    std::vector<InferenceServer::Request> InferenceServer::takeBatch()
+    {
+        std::vector<Request> batch;
+        size_t rows = 0;
+        while (!queue_.empty())
+        {
+            const size_t next_rows = queue_.front().nodes.size();
+            if (!batch.empty() && rows + next_rows > max_batch_size_)
+            {
+                break;
+            }
+            rows += next_rows;
+            batch.push_back(std::move(queue_.front()));
+            queue_.pop_front();
+        }
+        queued_rows_ -= rows;
+        return batch;
+    }
+
+    void InferenceServer::serve()
+    {
+        while (true)
+        {
+            std::vector<Request> requests;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                ready_.wait(lock, [this]
+                            { return stopping_ || !queue_.empty(); });
+                if (queue_.empty())
+                {
+                    return; // Stopping with nothing left to evaluate.
+                }
+
+                // Give the batch until the oldest request's deadline to fill up.
+                const auto deadline = queue_.front().submitted + max_wait_;
+                ready_.wait_until(lock, deadline, [this]
+                                  { return stopping_ || queued_rows_ >= max_batch_size_; });
+
+                requests = takeBatch();
+
+                const auto started = std::chrono::steady_clock::now();
+                for (const Request &request : requests)
+                {
+                    const auto wait = std::chrono::duration_cast<std::chrono::microseconds>(started - request.submitted);
+                    metrics_.totalWait += wait;
+                    metrics_.maxWait = std::max(metrics_.maxWait, wait);
+                }
+            }
+
+            batch_.clear();
+            for (const Request &request : requests)
+            {
+                batch_.insert(batch_.end(), request.nodes.begin(), request.nodes.end());
+            }
+
+            std::exception_ptr error;
+            try
+            {
+                evaluator_(batch_);
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                ++metrics_.batchSizeHistogram[batchSizeBucket(batch_.size())];
+                ++metrics_.batches;
+                metrics_.requests += requests.size();
+                metrics_.rows += batch_.size();
+            }
+
+            for (Request &request : requests)
+            {
+                if (error)
+                {
+                    request.done.set_exception(error);
+                }
+                else
+                {
+                    request.done.set_value();
+                }
+            }
+        }
+    }
+
+} // namespace scout
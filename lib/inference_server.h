@@ -0,0 +1,105 @@
+#ifndef WASM_SCOUT_LIB_INFERENCE_SERVER_H
+#define WASM_SCOUT_LIB_INFERENCE_SERVER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "lib/mcts.h"
+
+namespace scout
+{
+
+    /**
+     * @brief A queue in front of an Evaluator that merges requests from many threads.
+     *
+     * Producers submit batches of TreeNodes and receive a future that completes once
+     * the nodes' evaluations are written. A dedicated thread gathers pending requests
+     * until it holds `maxBatchSize` rows or the oldest request has waited `maxWait`,
+     * then evaluates them all with a single evaluator call (one session_.Run for an
+     * OnnxEvaluator). The wrapped evaluator is only ever called from that thread.
+     */
+    class InferenceServer
+    {
+    public:
+        // Snapshot of the server counters.
+        struct Metrics
+        {
+            // Requests currently waiting in the queue.
+            int queueDepth = 0;
+            // Number of evaluator calls and the requests and rows they carried.
+            std::uint64_t batches = 0;
+            std::uint64_t requests = 0;
+            std::uint64_t rows = 0;
+            // Evaluator calls by their rows, bucketed like SearchStats::batchSizes.
+            BatchSizeHistogram batchSizeHistogram{};
+            // Time from submission until the request's batch started evaluating.
+            std::chrono::microseconds totalWait{0};
+            std::chrono::microseconds maxWait{0};
+        };
+
+        /**
+         * @param evaluator The evaluator to serve; it needn't be thread-safe.
+         * @param maxBatchSize Maximum number of rows per evaluator call. A single larger
+         *        request is still evaluated, on its own.
+         * @param maxWait How long the oldest request may wait for the batch to fill.
+         */
+        InferenceServer(Evaluator evaluator, int maxBatchSize, std::chrono::microseconds maxWait);
+
+        // Evaluates the requests still queued, then stops the serving thread.
+        ~InferenceServer();
+
+        InferenceServer(const InferenceServer &) = delete;
+        InferenceServer &operator=(const InferenceServer &) = delete;
+
+        /**
+         * @brief Queues `nodes` for evaluation.
+         * The nodes must stay alive until the returned future is ready. An exception
+         * thrown by the evaluator is delivered through the future.
+         */
+        std::future<void> submit(std::vector<TreeNode *> nodes);
+
+        // Returns a blocking Evaluator backed by this server, for use by search threads.
+        Evaluator evaluator();
+
+        Metrics metrics() const;
+
+    private:
+        struct Request
+        {
+            std::vector<TreeNode *> nodes;
+            std::promise<void> done;
+            std::chrono::steady_clock::time_point submitted;
+        };
+
+        void serve();
+
+        // Moves the requests of the next batch out of the queue; requires mutex_.
+        std::vector<Request> takeBatch();
+
+        Evaluator evaluator_;
+        const size_t max_batch_size_;
+        const std::chrono::microseconds max_wait_;
+
+        mutable std::mutex mutex_;
+        std::condition_variable ready_;
+        std::deque<Request> queue_;
+        size_t queued_rows_ = 0;
+        bool stopping_ = false;
+        Metrics metrics_;
+
+        // Rows of the batch being evaluated, reused across calls.
+        std::vector<TreeNode *> batch_;
+
+        // Declared last so that it starts after everything it uses is constructed.
+        std::thread worker_;
+    };
+
+} // namespace scout
+
+#endif // WASM_SCOUT_LIB_INFERENCE_SERVER_H
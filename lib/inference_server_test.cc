@@ -0,0 +1,98 @@
+#include "lib/inference_server.h"
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+namespace scout
+{
+
+    TEST(InferenceServerTest, EvaluatesSubmittedNodes)
+    {
+        InferenceServer server(ZeroValueUniformEvaluator(GameState::NUM_MOVES), 64, std::chrono::microseconds(100));
+
+        TreeNode node(std::make_unique<GameState>(), GameState::NUM_MOVES);
+        node.evaluation().setValue(0.7f);
+        server.submit({&node}).get();
+
+        EXPECT_FLOAT_EQ(node.evaluation().getValue(), 0.0f);
+        EXPECT_FLOAT_EQ(node.evaluation().getPolicy()[0], 1.0f / GameState::NUM_MOVES);
+
+        auto metrics = server.metrics();
+        EXPECT_EQ(metrics.queueDepth, 0);
+        EXPECT_EQ(metrics.batches, 1u);
+        EXPECT_EQ(metrics.requests, 1u);
+        EXPECT_EQ(metrics.rows, 1u);
+        EXPECT_EQ(metrics.batchSizeHistogram[0], 1u);
+    }
+
+    TEST(InferenceServerTest, MergesConcurrentRequests)
+    {
+        std::atomic<size_t> largest_batch{0};
+        ZeroValueUniformEvaluator uniform(GameState::NUM_MOVES);
+        Evaluator recording = [&](const std::vector<TreeNode *> &nodes)
+        {
+            if (nodes.size() > largest_batch)
+            {
+                largest_batch = nodes.size();
+            }
+            uniform(nodes);
+        };
+        // A long wait lets the batch fill up to its maximum size.
+        InferenceServer server(recording, 4 * GameState::NUM_MOVES, std::chrono::milliseconds(50));
+
+        const int producers = 8;
+        const int rounds = 10;
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; ++p)
+        {
+            threads.emplace_back([&server]
+                                 {
+                TreeNode root(std::make_unique<GameState>(), GameState::NUM_MOVES);
+                root.createChildren();
+                std::vector<TreeNode *> children;
+                for (const auto &child : root.getChildStates())
+                {
+                    children.push_back(child.get());
+                }
+                Evaluator evaluator = server.evaluator();
+                for (int round = 0; round < rounds; ++round)
+                {
+                    evaluator(children);
+                } });
+        }
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+
+        auto metrics = server.metrics();
+        EXPECT_EQ(metrics.requests, static_cast<std::uint64_t>(producers * rounds));
+        EXPECT_EQ(metrics.rows, static_cast<std::uint64_t>(producers * rounds * GameState::NUM_MOVES));
+        EXPECT_LT(metrics.batches, metrics.requests);
+        EXPECT_LE(largest_batch.load(), 4u * GameState::NUM_MOVES);
+
+        std::uint64_t histogram_total = 0;
+        for (auto count : metrics.batchSizeHistogram)
+        {
+            histogram_total += count;
+        }
+        EXPECT_EQ(histogram_total, metrics.batches);
+        EXPECT_GE(metrics.maxWait.count(), 0);
+    }
+
+    TEST(InferenceServerTest, DeliversEvaluatorErrors)
+    {
+        Evaluator failing = [](const std::vector<TreeNode *> &)
+        { throw std::runtime_error("model failure"); };
+        InferenceServer server(failing, 16, std::chrono::microseconds(0));
+
+        TreeNode node(std::make_unique<GameState>(), GameState::NUM_MOVES);
+        auto done = server.submit({&node});
+        EXPECT_THROW(done.get(), std::runtime_error);
+    }
+
+} // namespace scout
@@ -1,9 +1,12 @@
 #include "lib/mcts.h"
 
 #include <algorithm>
-#include <deque>
+#include <bit>
+#include <chrono>
 #include <iterator>
+#include <random>
 #include <sstream>
+#include <unordered_set>
 #include <utility>
 
 #include "lib/model.h"
@@ -20,7 +23,7 @@ namespace scout
 
     int StateEvaluation::getNumberOfMoves() const
     {
-        return _policy.size();
+        return _compact ? _compactMoves : static_cast<int>(_policy.size());
     }
 
     float StateEvaluation::getValue() const
@@ -43,16 +46,48 @@ namespace scout
         return _policy;
     }
 
+    void StateEvaluation::compact()
+    {
+        if (_compact)
+        {
+            return;
+        }
+        if (_policy.size() > _compactPolicy.size())
+        {
+            throw std::logic_error("Policy is too large for a compact evaluation.");
+        }
+        _compactMoves = static_cast<std::uint8_t>(_policy.size());
+        for (int move = 0; move < _compactMoves; ++move)
+        {
+            _compactPolicy[move] = toFloat16(_policy[move]);
+        }
+        // Swapping with an empty vector frees the buffer; clear() would keep it.
+        std::vector<float>().swap(_policy);
+        _compact = true;
+    }
+
+    void StateEvaluation::reset()
+    {
+        _value = 0.0f;
+        if (_compact)
+        {
+            _policy.assign(_compactMoves, 0.0f);
+            _compact = false;
+        }
+        else
+        {
+            std::fill(_policy.begin(), _policy.end(), 0.0f);
+        }
+    }
+
     std::string StateEvaluation::toString() const
     {
         std::stringstream ss;
         ss << "StateEvaluation{value=" << _value << ", policy=[";
 
-        // Efficiently stream the vector contents, separated by commas.
-        if (!_policy.empty())
+        for (int move = 0; move < getNumberOfMoves(); ++move)
         {
-            std::copy(_policy.begin(), _policy.end() - 1, std::ostream_iterator<float>(ss, ", "));
-            ss << _policy.back();
+            ss << (move == 0 ? "" : ", ") << getPrior(move);
         }
 
         ss << "]}";
@@ -61,8 +96,18 @@ namespace scout
 
     bool StateEvaluation::operator==(const StateEvaluation &other) const
     {
-        // std::vector's operator== handles the element-wise array comparison.
-        return this->_value == other._value && this->_policy == other._policy;
+        if (this->_value != other._value || getNumberOfMoves() != other.getNumberOfMoves())
+        {
+            return false;
+        }
+        for (int move = 0; move < getNumberOfMoves(); ++move)
+        {
+            if (getPrior(move) != other.getPrior(move))
+            {
+                return false;
+            }
+        }
+        return true;
     }
 
     std::ostream &operator<<(std::ostream &os, const StateEvaluation &eval)
@@ -95,6 +140,16 @@ namespace scout
         }
     }
 
+    int AverageValue::getSupport() const
+    {
+        return _support;
+    }
+
+    float AverageValue::getPlayerOneTotal() const
+    {
+        return _playerOneValue;
+    }
+
     AverageValue &AverageValue::fromEvaluation(Player currentPlayer, float evaluatedValue)
     {
         this->_support = 1;
@@ -180,33 +235,35 @@ namespace scout
         }
     }
 
-    void ZeroValueUniformEvaluator::operator()(const std::vector<TreeNode *> &nodes) const
+    TreeNode::TreeNode(std::unique_ptr<GameState> state, int numMoves)
+        : _state(std::move(state)),
+          _evaluation(numMoves)
     {
-        for (TreeNode *node : nodes)
+        _childStates.resize(numMoves); // Pre-allocate space, filled with nullptr
+        if (_state->isGameOver())
         {
-            // Skip null pointers or nodes representing a completed game.
-            if (node == nullptr || node->state().isGameOver())
-            {
-                continue;
-            }
-
-            // Set the value to a neutral 0.
-            node->evaluation().setValue(0.0f);
-
-            // Get a mutable reference to the policy vector.
-            std::vector<float> &policy = node->evaluation().getPolicy();
-
-            // Fill the entire policy vector with the pre-calculated uniform value.
-            // This is the C++ equivalent of Java's Arrays.fill().
-            std::fill(policy.begin(), policy.end(), _policyValue);
+            _provenWinner = _state->getWinner().value_or(Player::NONE);
         }
     }
 
-    TreeNode::TreeNode(std::unique_ptr<GameState> state, int numMoves)
-        : _state(std::move(state)),
-          _evaluation(numMoves)
+    void TreeNode::reset(const GameState &state)
     {
-        _childStates.resize(numMoves); // Pre-allocate space, filled with nullptr
+        *_state = state;
+        _evaluation.reset();
+        _averageValue = AverageValue();
+        _outcomes = Outcomes();
+        // The children were released when the node was.
+        _sharedChildren = 0;
+        _excludedMoves = 0;
+        _hasPriorNoise = false;
+        _initialized = false;
+        _awaitingEvaluation = false;
+        _virtualLoss = 0;
+        _provenWinner.reset();
+        if (_state->isGameOver())
+        {
+            _provenWinner = _state->getWinner().value_or(Player::NONE);
+        }
     }
 
     void TreeNode::update(Player winner, const AverageValue &averageValue)
@@ -215,12 +272,30 @@ namespace scout
         this->_averageValue += averageValue; // Use the overloaded operator+=
     }
 
-    std::optional<AverageValue> TreeNode::initChildren(const Evaluator &evaluator)
+    std::optional<AverageValue> TreeNode::initChildren(const Evaluator &evaluator,
+                                                       TranspositionTable *transpositions, int depth)
     {
-        if (isInitialized())
+        if (!createChildren(transpositions, depth))
         {
             return std::nullopt;
         }
+
+        // The evaluator processes the batch of new child nodes.
+        // We create a vector of raw pointers to pass to it.
+        std::vector<TreeNode *> child_raw_ptrs;
+        child_raw_ptrs.reserve(_childStates.size());
+        appendChildRows(child_raw_ptrs);
+        evaluator(child_raw_ptrs);
+
+        return collectChildrenValue();
+    }
+
+    bool TreeNode::createChildren(TranspositionTable *transpositions, int depth, NodePool *pool)
+    {
+        if (isInitialized())
+        {
+            return false;
+        }
         _initialized = true;
 
         int numberOfMoves = _evaluation.getNumberOfMoves();
@@ -230,20 +305,56 @@ namespace scout
             {
                 continue;
             }
+            GameState childState = _state->afterMove(move);
+            if (transpositions != nullptr)
+            {
+                if (auto shared = transpositions->find(childState, depth + 1))
+                {
+                    _childStates[move] = std::move(shared);
+                    _sharedChildren |= 1u << move;
+                    continue;
+                }
+            }
             // Create a new child node by making a move from the current state.
-            _childStates[move] = std::make_unique<TreeNode>(_state->move(move), numberOfMoves);
+            if (pool != nullptr)
+            {
+                _childStates[move] = pool->acquire(childState);
+            }
+            else
+            {
+                _childStates[move] = std::make_shared<TreeNode>(std::make_unique<GameState>(childState), numberOfMoves);
+            }
+            if (transpositions != nullptr)
+            {
+                transpositions->insert(_childStates[move], depth + 1);
+            }
         }
+        return true;
+    }
 
-        // The evaluator processes the batch of new child nodes.
-        // We create a vector of raw pointers to pass to it.
-        std::vector<TreeNode *> child_raw_ptrs;
-        child_raw_ptrs.reserve(_childStates.size());
-        for (const auto &child_ptr : _childStates)
+    void TreeNode::appendChildRows(std::vector<TreeNode *> &rows) const
+    {
+        for (size_t move = 0; move < _childStates.size(); ++move)
         {
-            child_raw_ptrs.push_back(child_ptr.get());
+            const bool shared = (_sharedChildren >> move) & 1u;
+            rows.push_back(shared ? nullptr : _childStates[move].get());
         }
-        evaluator(child_raw_ptrs);
+    }
+
+    void TreeNode::appendNewChildren(std::vector<TreeNode *> &nodes) const
+    {
+        for (size_t move = 0; move < _childStates.size(); ++move)
+        {
+            if (_childStates[move] != nullptr && !((_sharedChildren >> move) & 1u))
+            {
+                nodes.push_back(_childStates[move].get());
+            }
+        }
+    }
 
+    AverageValue TreeNode::collectChildrenValue(bool compactPriors)
+    {
+        int numberOfMoves = _evaluation.getNumberOfMoves();
         AverageValue childrenAverageValue;
         for (int move = 0; move < numberOfMoves; ++move)
         {
@@ -252,16 +363,149 @@ namespace scout
                 continue;
             }
             TreeNode *childNode = _childStates[move].get();
+            if ((_sharedChildren >> move) & 1u)
+            {
+                // A shared child keeps the statistics gathered through its other parents.
+                childrenAverageValue += AverageValue().fromEvaluation(
+                    childNode->state().getCurrentPlayer(),
+                    childNode->evaluation().getValue());
+                continue;
+            }
             // Set the child's initial value from the evaluator's result.
             childNode->getAverageValue().fromEvaluation(
                 childNode->state().getCurrentPlayer(),
                 childNode->evaluation().getValue());
             childrenAverageValue += childNode->getAverageValue();
+            if (compactPriors)
+            {
+                childNode->evaluation().compact();
+            }
         }
 
         return childrenAverageValue;
     }
 
+    bool TreeNode::updateProof()
+    {
+        if (_provenWinner.has_value())
+        {
+            return true;
+        }
+        if (!_initialized)
+        {
+            return false;
+        }
+
+        const Player mover = _state->getCurrentPlayer();
+        bool allProven = true;
+        bool drawAvailable = false;
+        std::optional<Player> opponentWin;
+        for (const auto &child : _childStates)
+        {
+            if (child == nullptr)
+            {
+                continue;
+            }
+            const std::optional<Player> &winner = child->getProvenWinner();
+            if (!winner.has_value())
+            {
+                allProven = false;
+            }
+            else if (*winner == mover)
+            {
+                // One winning move is enough.
+                _provenWinner = mover;
+                return true;
+            }
+            else if (*winner == Player::NONE)
+            {
+                drawAvailable = true;
+            }
+            else
+            {
+                opponentWin = winner;
+            }
+        }
+
+        // Every move is proven: the mover settles for a draw if it can.
+        if (!allProven)
+        {
+            return false;
+        }
+        if (drawAvailable)
+        {
+            _provenWinner = Player::NONE;
+        }
+        else if (opponentWin.has_value())
+        {
+            _provenWinner = opponentWin;
+        }
+        return _provenWinner.has_value();
+    }
+
+    namespace
+    {
+        // Whether proven draws rank above the moves that aren't proven, for `mover` at
+        // `node`: a draw is worth 0, so it does unless the most visited unproven move is
+        // worth more than that. Ties go to the draw, which is certain.
+        bool drawsBeatUnproven(const TreeNode &node, Player mover)
+        {
+            const TreeNode *most_visited = nullptr;
+            for (const auto &child : node.getChildStates())
+            {
+                if (child != nullptr && !child->isProven() &&
+                    (most_visited == nullptr || child->getVisits() > most_visited->getVisits()))
+                {
+                    most_visited = child.get();
+                }
+            }
+            return most_visited == nullptr || most_visited->getAverageValue().getValue(mover) <= 0.0f;
+        }
+
+        // Ranks a child by its proof for `mover`: 4 for a proven win, 0 for a proven loss,
+        // 2 for a move that isn't proven, and 3 or 1 for a proven draw depending on
+        // `draws_beat_unproven`.
+        int moveRank(const TreeNode &child, Player mover, bool draws_beat_unproven)
+        {
+            const std::optional<Player> &winner = child.getProvenWinner();
+            if (!winner.has_value())
+            {
+                return 2;
+            }
+            if (*winner == Player::NONE)
+            {
+                return draws_beat_unproven ? 3 : 1;
+            }
+            return *winner == mover ? 4 : 0;
+        }
+    }
+
+    int TreeNode::getBestMove() const
+    {
+        const Player mover = _state->getCurrentPlayer();
+        const bool draws_beat_unproven = drawsBeatUnproven(*this, mover);
+        int best_move = -1;
+        int best_rank = -1;
+        int best_visits = -1;
+        for (size_t move = 0; move < _childStates.size(); ++move)
+        {
+            const auto &child = _childStates[move];
+            if (child == nullptr)
+            {
+                continue;
+            }
+            const int rank = moveRank(*child, mover, draws_beat_unproven);
+            const int visits = child->getVisits();
+            if (rank > best_rank || (rank == best_rank && visits > best_visits))
+            {
+                best_move = static_cast<int>(move);
+                best_rank = rank;
+                best_visits = visits;
+            }
+        }
+        return best_move;
+    }
+
     std::vector<float> TreeNode::encode() const
     {
         if (isLeaf())
@@ -271,6 +515,15 @@ namespace scout
 
         std::vector<float> outputs(_childStates.size() + 1);
 
+        if (_provenWinner.has_value())
+        {
+            // The exact result replaces the sampled statistics.
+            const Player mover = _state->getCurrentPlayer();
+            outputs[0] = *_provenWinner == Player::NONE ? 0.0f : (*_provenWinner == mover ? 1.0f : -1.0f);
+            outputs[getBestMove() + 1] = 1.0f;
+            return outputs;
+        }
+
         outputs[0] = _averageValue.getValue(_state->getCurrentPlayer());
 
         float totalVisits = 0;
@@ -302,10 +555,43 @@ namespace scout
     const GameState &TreeNode::state() const { return *_state; }
     StateEvaluation &TreeNode::evaluation() { return _evaluation; }
     const StateEvaluation &TreeNode::evaluation() const { return _evaluation; }
-    const std::vector<std::unique_ptr<TreeNode>> &TreeNode::getChildStates() const { return _childStates; }
+    const std::vector<std::shared_ptr<TreeNode>> &TreeNode::getChildStates() const { return _childStates; }
     const Outcomes &TreeNode::getOutcomes() const { return _outcomes; }
     AverageValue &TreeNode::getAverageValue() { return _averageValue; }
+    const AverageValue &TreeNode::getAverageValue() const { return _averageValue; }
     bool TreeNode::isInitialized() const { return _initialized; }
+    void TreeNode::addVirtualLoss() { ++_virtualLoss; }
+    void TreeNode::removeVirtualLoss() { --_virtualLoss; }
+    int TreeNode::getVirtualLoss() const { return _virtualLoss; }
+    void TreeNode::setAwaitingEvaluation(bool awaiting) { _awaitingEvaluation = awaiting; }
+    bool TreeNode::isAwaitingEvaluation() const { return _awaitingEvaluation; }
+    void TreeNode::excludeMove(int move) { _excludedMoves |= 1u << move; }
+    void TreeNode::clearExcludedMoves() { _excludedMoves = 0; }
+    bool TreeNode::isMoveExcluded(int move) const { return (_excludedMoves >> move) & 1u; }
+    void TreeNode::pruneChildren()
+    {
+        for (auto &child : _childStates)
+        {
+            child.reset();
+        }
+        _sharedChildren = 0;
+        _excludedMoves = 0;
+        _hasPriorNoise = false;
+        _initialized = false;
+    }
+
+    bool TreeNode::hasPriorNoise() const { return _hasPriorNoise; }
+    const std::array<float, GameState::NUM_MOVES> &TreeNode::getPriorNoise() const { return _priorNoise; }
+
+    void TreeNode::setPriorNoise(const std::array<float, GameState::NUM_MOVES> &noise)
+    {
+        _priorNoise = noise;
+        _hasPriorNoise = true;
+    }
+    const std::optional<Player> &TreeNode::getProvenWinner() const { return _provenWinner; }
+    bool TreeNode::isProven() const { return _provenWinner.has_value(); }
+
+    void TreeNode::setProvenWinner(Player winner) { _provenWinner = winner; }
     bool TreeNode::isLeaf() const { return !_initialized || _state->isGameOver(); }
     int TreeNode::getVisits() const { return _outcomes.getTotalOutcomes(); }
 
@@ -320,6 +606,46 @@ namespace scout
         return ss.str();
     }
 
+    std::shared_ptr<TreeNode> TranspositionTable::find(const GameState &state, int depth)
+    {
+        ++lookups_;
+        auto it = nodes_.find(Key{state.hash(), depth});
+        if (it == nodes_.end())
+        {
+            return nullptr;
+        }
+        std::shared_ptr<TreeNode> node = it->second.lock();
+        if (node == nullptr)
+        {
+            nodes_.erase(it);
+            return nullptr;
+        }
+        // Guard against hash collisions.
+        if (!(node->state() == state))
+        {
+            return nullptr;
+        }
+        ++hits_;
+        return node;
+    }
+
+    void TranspositionTable::insert(const std::shared_ptr<TreeNode> &node, int depth)
+    {
+        nodes_[Key{node->state().hash(), depth}] = node;
+    }
+
+    void TranspositionTable::clear()
+    {
+        nodes_.clear();
+        lookups_ = 0;
+        hits_ = 0;
+    }
+
+    size_t TranspositionTable::size() const
+    {
+        return nodes_.size();
+    }
+
     namespace
     { // Anonymous namespace for internal helper function
         // Helper to create an Ort::Env with specific threading options.
@@ -332,53 +658,77 @@ namespace scout
         }
     }
 
-    OnnxEvaluator::OnnxEvaluator() : env_(create_env_with_threading_options()),
-                                     session_(env_, nine_pebbles_ort, nine_pebbles_ort_len, Ort::SessionOptions{nullptr}),
-                                     memory_info_(Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeCPU))
+    OnnxEvaluator::OnnxEvaluator(size_t maxBatchSize)
+        : env_(create_env_with_threading_options()),
+          session_(env_, nine_pebbles_ort, nine_pebbles_ort_len, Ort::SessionOptions{nullptr}),
+          memory_info_(Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeCPU)),
+          max_batch_size_(maxBatchSize)
     {
+        if (maxBatchSize == 0)
+        {
+            throw std::invalid_argument("The maximum batch size must be positive.");
+        }
 
-        // Initialize the shape with a placeholder for the batch size (dim 0).
+        batch_input_.resize(max_batch_size_ * num_features_);
+        value_output_.resize(max_batch_size_);
+        policy_output_.resize(max_batch_size_ * num_moves_);
+
+        // Initialize the shapes with a placeholder for the batch size (dim 0).
         input_shape_ = {1, static_cast<int64_t>(num_features_)};
+        policy_shape_ = {1, static_cast<int64_t>(num_moves_)};
+        // The value output holds one float per row, as {batch} or {batch, 1}.
+        value_shape_ = {1, 1};
+        Ort::AllocatorWithDefaultOptions allocator;
+        for (size_t i = 0; i < session_.GetOutputCount(); ++i)
+        {
+            if (std::string(session_.GetOutputNameAllocated(i, allocator).get()) == VALUE_OUTPUT_NAME)
+            {
+                const size_t rank = session_.GetOutputTypeInfo(i).GetTensorTypeAndShapeInfo().GetShape().size();
+                value_shape_.assign(std::max<size_t>(rank, 1), 1);
+            }
+        }
     }
 
     void OnnxEvaluator::operator()(const std::vector<TreeNode *> &nodes)
     {
-        if (nodes.empty())
+        for (size_t first = 0; first < nodes.size(); first += max_batch_size_)
         {
-            return;
+            evaluateRows(nodes, first, std::min(max_batch_size_, nodes.size() - first));
         }
+    }
 
-        const size_t batch_size = nodes.size();
-
+    void OnnxEvaluator::evaluateRows(const std::vector<TreeNode *> &nodes, size_t first, size_t count)
+    {
         // 1. Prepare the input batch tensor
-        // Resize the flat input vector to hold all game states for this batch.
-        batch_input_.resize(batch_size * num_features_);
-
-        for (size_t i = 0; i < batch_size; ++i)
+        for (size_t i = 0; i < count; ++i)
         {
-            if (nodes[i] != nullptr)
+            float *row = batch_input_.data() + i * num_features_;
+            if (nodes[first + i] != nullptr)
             {
-                // Get the encoded features from the node's game state.
-                const auto &encoded_state = nodes[i]->state().encode();
-                // Copy the features into the correct position in the batch vector.
-                std::memcpy(batch_input_.data() + (i * num_features_), encoded_state.data(), num_features_ * sizeof(float));
+                // Encode the node's game state straight into its row of the batch.
+                nodes[first + i]->state().encodeInto(row);
             }
             else
             {
                 // If a node is null, its corresponding part of the batch is zeroed out.
-                std::memset(batch_input_.data() + (i * num_features_), 0, num_features_ * sizeof(float));
+                std::memset(row, 0, num_features_ * sizeof(float));
             }
         }
 
-        // Update the input shape for the current batch size.
-        input_shape_[0] = static_cast<int64_t>(batch_size);
+        // Update the shapes for the current batch size.
+        const int64_t batch_size = static_cast<int64_t>(count);
+        input_shape_[0] = batch_size;
+        value_shape_[0] = batch_size;
+        policy_shape_[0] = batch_size;
 
         Ort::Value input_tensor = Ort::Value::CreateTensor<float>(
-            memory_info_,
-            batch_input_.data(),
-            batch_input_.size(),
-            input_shape_.data(),
-            input_shape_.size());
+            memory_info_, batch_input_.data(), count * num_features_, input_shape_.data(), input_shape_.size());
+        // The model writes its results into the pre-allocated output buffers.
+        Ort::Value output_tensors[] = {
+            Ort::Value::CreateTensor<float>(memory_info_, value_output_.data(), count, value_shape_.data(),
+                                            value_shape_.size()),
+            Ort::Value::CreateTensor<float>(memory_info_, policy_output_.data(), count * num_moves_,
+                                            policy_shape_.data(), policy_shape_.size())};
 
         // 2. Run inference
         const char *input_names[] = {INPUT_NAME};
@@ -386,191 +736,398 @@ namespace scout
 
         try
         {
-            auto output_tensors = session_.Run(
-                Ort::RunOptions{nullptr},
-                input_names, &input_tensor, 1,
-                output_names, 2);
-
-            // 3. Distribute the results back to the TreeNodes
-            const float *value_ptr = output_tensors[0].GetTensorData<float>();
-            const float *policy_ptr = output_tensors[1].GetTensorData<float>();
+            session_.Run(Ort::RunOptions{nullptr}, input_names, &input_tensor, 1, output_names, output_tensors, 2);
+        }
+        catch (const Ort::Exception &e)
+        {
+            throw std::runtime_error("ONNX Runtime exception: " + std::string(e.what()));
+        }
 
-            for (size_t i = 0; i < batch_size; ++i)
+        // 3. Distribute the results back to the TreeNodes
+        for (size_t i = 0; i < count; ++i)
+        {
+            TreeNode *node = nodes[first + i];
+            if (node == nullptr)
             {
-                if (nodes[i] == nullptr)
-                {
-                    continue;
-                }
+                continue;
+            }
 
-                // Get a mutable reference to the node's evaluation object.
-                StateEvaluation &eval = nodes[i]->evaluation();
+            // Get a mutable reference to the node's evaluation object.
+            StateEvaluation &eval = node->evaluation();
 
-                // Set the scalar value.
-                eval.setValue(value_ptr[i]);
+            // Set the scalar value.
+            eval.setValue(value_output_[i]);
 
-                // Copy the policy vector from the output tensor.
-                std::vector<float> &policy_vec = eval.getPolicy();
-                std::memcpy(policy_vec.data(), policy_ptr + (i * num_moves_), num_moves_ * sizeof(float));
-            }
+            // Copy the policy vector from the output buffer.
+            std::vector<float> &policy_vec = eval.getPolicy();
+            std::memcpy(policy_vec.data(), policy_output_.data() + i * num_moves_, num_moves_ * sizeof(float));
         }
-        catch (const Ort::Exception &e)
+    }
+
+    NodePool::NodePool() : control_blocks_(new ControlBlocks()) {}
+
+    NodePool::~NodePool()
+    {
+        for (TreeNode *node : free_nodes_)
         {
-            throw std::runtime_error("ONNX Runtime exception: " + std::string(e.what()));
+            delete node;
         }
+        control_blocks_->orphan();
     }
 
-    PredictiveUpperConfidenceBound::PredictiveUpperConfidenceBound()
-        : // Seed the random number generator. For production, a better seed is recommended.
-          random_generator_(std::random_device{}()),
-          // A symmetric Dirichlet(1.0) sample can be generated from Gamma(1.0, 1.0).
-          gamma_distribution_(1.0, 1.0)
+    void NodePool::ControlBlocks::orphan()
     {
+        orphaned_ = true;
+        if (blocks_in_use_ == 0)
+        {
+            delete this;
+        }
     }
 
-    std::vector<double> PredictiveUpperConfidenceBound::sampleDirichlet()
+    void *NodePool::ControlBlocks::do_allocate(size_t bytes, size_t alignment)
     {
-        std::vector<double> sample(num_moves_);
-        double sum = 0.0;
+        void *block = blocks_.allocate(bytes, alignment);
+        ++blocks_in_use_;
+        return block;
+    }
 
-        for (size_t i = 0; i < num_moves_; ++i)
+    void NodePool::ControlBlocks::do_deallocate(void *block, size_t bytes, size_t alignment)
+    {
+        blocks_.deallocate(block, bytes, alignment);
+        // The last weak_ptr to a node of a destroyed pool takes the resource with it.
+        if (--blocks_in_use_ == 0 && orphaned_)
         {
-            sample[i] = gamma_distribution_(random_generator_);
-            sum += sample[i];
+            delete this;
         }
+    }
 
-        // Normalize the samples to get the Dirichlet distribution
-        if (sum > 0.0)
+    std::shared_ptr<TreeNode> NodePool::acquire(const GameState &state)
+    {
+        TreeNode *node;
+        if (free_nodes_.empty())
         {
-            for (size_t i = 0; i < num_moves_; ++i)
-            {
-                sample[i] /= sum;
-            }
+            node = new TreeNode(std::make_unique<GameState>(state), GameState::NUM_MOVES);
+            ++created_nodes_;
+        }
+        else
+        {
+            node = free_nodes_.back();
+            free_nodes_.pop_back();
+            node->reset(state);
         }
+        return std::shared_ptr<TreeNode>(node, Recycler{this}, std::pmr::polymorphic_allocator<TreeNode>(control_blocks_));
+    }
 
-        return sample;
+    void NodePool::setByteBudget(size_t bytes)
+    {
+        byte_budget_ = bytes;
     }
 
-    int PredictiveUpperConfidenceBound::operator()(const TreeNode &treeNode)
+    bool NodePool::isOverBudget() const
     {
-        if (!treeNode.isInitialized())
+        return byte_budget_ > 0 && getBytesInUse() > byte_budget_;
+    }
+
+    size_t NodePool::prune(TreeNode &root)
+    {
+        if (!isOverBudget())
         {
-            throw std::logic_error("State node is not initialized!");
+            return 0;
         }
-        if (treeNode.isLeaf())
+        const size_t live_before = getLiveNodes();
+        const size_t target = byte_budget_ / 4 * 3 / bytesPerNode(compact_priors_);
+        const size_t needed = live_before > target ? live_before - target : 0;
+
+        // Every expanded node below the root, with the children its pruning would release.
+        // A child shared with another parent through a transposition table outlives the
+        // pruning, and its visits aren't bounded by this parent's, so the walk neither
+        // counts nor descends into shared children: it only follows the edges that own
+        // their node alone. That also visits every node at most once.
+        candidates_.clear();
+        stack_.clear();
+        auto pushChildren = [this](const TreeNode &node)
         {
-            throw std::logic_error("State node is a leaf!");
+            for (const auto &child : node.getChildStates())
+            {
+                if (child != nullptr && child.use_count() == 1 && child->isInitialized())
+                {
+                    stack_.push_back(child.get());
+                }
+            }
+        };
+        pushChildren(root);
+        while (!stack_.empty())
+        {
+            TreeNode *node = stack_.back();
+            stack_.pop_back();
+            int children = 0;
+            for (const auto &child : node->getChildStates())
+            {
+                children += child != nullptr && child.use_count() == 1;
+            }
+            candidates_.push_back({node->getVisits(), children});
+            pushChildren(*node);
+        }
+        if (candidates_.empty())
+        {
+            return 0;
         }
 
-        float max_value = -std::numeric_limits<float>::max();
-        int index_of_max = -1;
-
-        const auto noises = sampleDirichlet();
-
-        const double parent_visits_sqrt = std::sqrt(1.0 + treeNode.getVisits());
-        const auto &children = treeNode.getChildStates();
-        const auto &policy = treeNode.evaluation().getPolicy();
+        // The smallest visit threshold whose subtrees hold enough nodes.
+        std::sort(candidates_.begin(), candidates_.end(), [](const Candidate &a, const Candidate &b)
+                  { return a.visits < b.visits; });
+        int threshold = candidates_.back().visits;
+        size_t released = 0;
+        for (const Candidate &candidate : candidates_)
+        {
+            released += candidate.children;
+            if (released >= needed)
+            {
+                threshold = candidate.visits;
+                break;
+            }
+        }
 
-        for (size_t i = 0; i < children.size(); ++i)
+        // Prunes the topmost expanded nodes at or below the threshold.
+        stack_.clear();
+        pushChildren(root);
+        while (!stack_.empty())
         {
-            const auto &child_state = children[i];
-            if (child_state == nullptr)
+            TreeNode *node = stack_.back();
+            stack_.pop_back();
+            if (node->getVisits() <= threshold)
             {
-                continue;
+                node->pruneChildren();
+            }
+            else
+            {
+                pushChildren(*node);
             }
+        }
 
-            const float prior_probability = policy[i];
+        const size_t pruned = live_before - std::min(live_before, getLiveNodes());
+        ++prunings_;
+        pruned_nodes_ += pruned;
+        return pruned;
+    }
 
-            const float adjusted_probability =
-                (prior_probability * (1.0f - NOISE_WEIGHT)) + (NOISE_WEIGHT * noises[i]);
+    void NodePool::Recycler::operator()(TreeNode *node) const
+    {
+        // Releases the subtree (into this pool, for pooled children) before the node is reused.
+        for (auto &child : node->_childStates)
+        {
+            child.reset();
+        }
+        pool->free_nodes_.push_back(node);
+    }
 
-            const float exploration = static_cast<float>(
-                adjusted_probability * parent_visits_sqrt / (1.0 + child_state->getVisits()));
+    PredictiveUpperConfidenceBound::PredictiveUpperConfidenceBound()
+        : PredictiveUpperConfidenceBound(std::random_device{}())
+    {
+    }
 
-            const float exploitation =
-                child_state->getAverageValue().getValue(treeNode.state().getCurrentPlayer());
+    PredictiveUpperConfidenceBound::PredictiveUpperConfidenceBound(std::uint32_t seed)
+        : random_generator_(seed)
+    {
+    }
 
-            const float estimated_value = exploitation + EXPLORATION_WEIGHT * exploration;
+    std::array<float, GameState::NUM_MOVES> PredictiveUpperConfidenceBound::sampleDirichlet()
+    {
+        // A symmetric Dirichlet(1.0) sample can be generated from Gamma(1.0, 1.0), which
+        // is the exponential distribution: -log of a uniform variate.
+        std::array<float, GameState::NUM_MOVES> sample;
+        float sum = 0.0f;
+        for (float &variate : sample)
+        {
+            variate = -std::log(random_generator_.uniformPositive());
+            sum += variate;
+        }
 
-            if (estimated_value > max_value)
+        // Normalize the samples to get the Dirichlet distribution
+        if (sum > 0.0f)
+        {
+            for (float &variate : sample)
             {
-                max_value = estimated_value;
-                index_of_max = i;
+                variate /= sum;
             }
         }
 
-        if (index_of_max == -1)
-        {
-            throw std::runtime_error("Could not find any valid child states.");
-        }
+        return sample;
+    }
 
-        return index_of_max;
+    double SearchStats::averageDepth() const
+    {
+        return simulations == 0 ? 0.0 : static_cast<double>(totalDepth) / simulations;
     }
 
-    MonteCarloTreeSearch::MonteCarloTreeSearch(ExpansionStrategy strategy, Evaluator evaluator)
-        : expansion_strategy_(std::move(strategy)),
-          evaluator_(std::move(evaluator)) {}
+    double SearchStats::simulationsPerSecond() const
+    {
+        return elapsed.count() == 0 ? 0.0 : simulations / std::chrono::duration<double>(elapsed).count();
+    }
 
-    void MonteCarloTreeSearch::expand(TreeNode *currentNode)
+    void SearchStats::recordBatch(size_t rows)
     {
-        if (!currentNode)
-            return;
+        ++evaluatorCalls;
+        evaluatedRows += rows;
+        ++batchSizes[batchSizeBucket(rows)];
+    }
 
-        // The backpropagation path stores the node and the value of its immediate children.
-        std::deque<std::pair<TreeNode *, std::optional<AverageValue>>> backprop_stack;
+    void SearchStats::recordSimulation(int depth)
+    {
+        ++simulations;
+        totalDepth += depth;
+        maxDepth = std::max(maxDepth, depth);
+    }
 
-        int expansions = 0;
-        // 1. SELECTION: Traverse the tree until a leaf node or unexpanded node is found.
-        while (!currentNode->state().isGameOver() && expansions++ < 200)
+    SearchStats &SearchStats::operator+=(const SearchStats &other)
+    {
+        simulations += other.simulations;
+        evaluatorCalls += other.evaluatorCalls;
+        evaluatedRows += other.evaluatedRows;
+        for (int bucket = 0; bucket < BATCH_SIZE_BUCKETS; ++bucket)
         {
-            // 2. EXPANSION: If the node is unvisited, initialize its children.
-            std::optional<AverageValue> child_value = currentNode->initChildren(evaluator_);
+            batchSizes[bucket] += other.batchSizes[bucket];
+        }
+        terminalHits += other.terminalHits;
+        deferredExpansions += other.deferredExpansions;
+        maxDepth = std::max(maxDepth, other.maxDepth);
+        totalDepth += other.totalDepth;
+        nodes += other.nodes;
+        bytes += other.bytes;
+        selectionTime += other.selectionTime;
+        expansionTime += other.expansionTime;
+        evaluationTime += other.evaluationTime;
+        backpropagationTime += other.backpropagationTime;
+        elapsed = std::max(elapsed, other.elapsed);
+        return *this;
+    }
 
-            backprop_stack.emplace_back(currentNode, child_value);
+    std::string SearchStats::toString() const
+    {
+        using Milliseconds = std::chrono::duration<double, std::milli>;
+        std::stringstream ss;
+        ss << "SearchStats{simulations=" << simulations
+           << ", evaluatorCalls=" << evaluatorCalls
+           << ", evaluatedRows=" << evaluatedRows
+           << ", terminalHits=" << terminalHits
+           << ", deferredExpansions=" << deferredExpansions
+           << ", depth=" << averageDepth() << "/" << maxDepth
+           << ", nodes=" << nodes
+           << ", bytes=" << bytes
+           << ", simulationsPerSecond=" << simulationsPerSecond()
+           << ", ms{selection=" << Milliseconds(selectionTime).count()
+           << ", expansion=" << Milliseconds(expansionTime).count()
+           << ", evaluation=" << Milliseconds(evaluationTime).count()
+           << ", backpropagation=" << Milliseconds(backpropagationTime).count()
+           << ", elapsed=" << Milliseconds(elapsed).count() << "}}";
+        return ss.str();
+    }
 
-            // If child_value has a value, it means we just expanded this node.
-            // The simulation result is this neural network evaluation. Break to backpropagate.
-            if (child_value.has_value())
+    size_t countNodes(const TreeNode &root)
+    {
+        size_t nodes = 0;
+        std::vector<const TreeNode *> stack = {&root};
+        while (!stack.empty())
+        {
+            const TreeNode *node = stack.back();
+            stack.pop_back();
+            ++nodes;
+            for (const auto &child : node->getChildStates())
             {
-                break;
+                if (child != nullptr)
+                {
+                    stack.push_back(child.get());
+                }
             }
-
-            // If the node was already expanded, select the best child and continue traversal.
-            int move_idx = expansion_strategy_(*currentNode);
-            currentNode = currentNode->getChildStates()[move_idx].get();
         }
+        return nodes;
+    }
 
-        // 3. SIMULATION & BACKPROPAGATION
-        AverageValue accumulated_value;
-        Player winner = Player::NONE;
+    size_t countBytes(const TreeNode &root)
+    {
+        size_t bytes = 0;
+        // Nodes reached through more than one parent, so that they count once.
+        std::unordered_set<const TreeNode *> shared;
+        std::vector<const TreeNode *> stack = {&root};
+        while (!stack.empty())
+        {
+            const TreeNode *node = stack.back();
+            stack.pop_back();
+            bytes += sizeof(TreeNode) + sizeof(GameState) + NodePool::CONTROL_BLOCK_BYTES +
+                     node->evaluation().getPolicy().capacity() * sizeof(float) +
+                     node->getChildStates().capacity() * sizeof(std::shared_ptr<TreeNode>);
+            for (const auto &child : node->getChildStates())
+            {
+                if (child != nullptr && (child.use_count() == 1 || shared.insert(child.get()).second))
+                {
+                    stack.push_back(child.get());
+                }
+            }
+        }
+        return bytes;
+    }
 
-        // Check if the loop was broken by expansion (child_value has value).
-        auto &last_path_item = backprop_stack.back();
-        if (last_path_item.second.has_value())
+    std::vector<MoveAnalysis> analyzeRoot(const TreeNode &root, int lines)
+    {
+        const Player mover = root.state().getCurrentPlayer();
+        const auto &children = root.getChildStates();
+        std::vector<std::pair<int, const TreeNode *>> ranked;
+        for (size_t move = 0; move < children.size(); ++move)
         {
-            accumulated_value = last_path_item.second.value();
-            // The "winner" in this case isn't a game win, but the perspective for the value.
-            // We use the player whose turn it was at the expanded node.
-            winner = last_path_item.first->state().getCurrentPlayer();
+            if (children[move] != nullptr)
+            {
+                ranked.emplace_back(static_cast<int>(move), children[move].get());
+            }
         }
-        // Otherwise, the loop ended because the game is over.
-        else if (currentNode->state().isGameOver())
+        const bool draws_beat_unproven = drawsBeatUnproven(root, mover);
+        // Stable, so equal moves keep the move order getBestMove() breaks ties with.
+        std::stable_sort(ranked.begin(), ranked.end(), [mover, draws_beat_unproven](const auto &a, const auto &b)
+                         {
+                             const int rank_a = moveRank(*a.second, mover, draws_beat_unproven);
+                             const int rank_b = moveRank(*b.second, mover, draws_beat_unproven);
+                             return rank_a != rank_b ? rank_a > rank_b : a.second->getVisits() > b.second->getVisits(); });
+        ranked.resize(std::min<size_t>(ranked.size(), std::max(lines, 0)));
+
+        std::vector<MoveAnalysis> analysis;
+        analysis.reserve(ranked.size());
+        for (const auto &[move, child] : ranked)
         {
-            auto winner_opt = currentNode->state().getWinner();
-            if (winner_opt.has_value())
+            MoveAnalysis line;
+            line.move = move;
+            line.visits = child->getVisits();
+            line.value = child->getAverageValue().getValue(mover);
+            line.prior = root.evaluation().getPrior(move);
+            line.provenWinner = child->getProvenWinner();
+            line.principalVariation.push_back(move);
+            for (const TreeNode *node = child; static_cast<int>(line.principalVariation.size()) < MAX_PV_LENGTH;)
             {
-                winner = winner_opt.value();
+                const int reply = node->getBestMove();
+                if (reply < 0)
+                {
+                    break;
+                }
+                line.principalVariation.push_back(reply);
+                node = node->getChildStates()[reply].get();
             }
-            accumulated_value.addWinner(winner);
-            currentNode->update(winner, accumulated_value);
+            analysis.push_back(std::move(line));
         }
+        return analysis;
+    }
 
-        // Backpropagate the results up the tree.
-        while (!backprop_stack.empty())
+    void backpropagate(const std::vector<TreeNode *> &path, Player winner, const AverageValue &value)
+    {
+        // A node can only become proven if the child below it on the path is proven.
+        bool proving = true;
+        for (auto it = path.rbegin(); it != path.rend(); ++it)
         {
-            auto path_node = backprop_stack.back().first;
-            backprop_stack.pop_back();
-            path_node->update(winner, accumulated_value);
+            (*it)->update(winner, value);
+            if (proving)
+            {
+                proving = (*it)->updateProof();
+            }
         }
     }
 
+    template class BasicMonteCarloTreeSearch<ExpansionStrategy, Evaluator>;
+
 }
\ No newline at end of file
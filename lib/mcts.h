@@ -1,14 +1,26 @@
 #ifndef WASM_SCOUT_LIB_MCTS_H
 #define WASM_SCOUT_LIB_MCTS_H
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <functional>
+#include <limits>
 #include <memory>
+#include <memory_resource>
 #include <optional>
-#include <random>
+#include <stdexcept>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
+#include "lib/float16.h"
 #include "lib/game.h"
+#include "lib/random.h"
 #include "onnxruntime/core/session/onnxruntime_cxx_api.h"
 
 namespace scout
@@ -23,7 +35,7 @@ namespace scout
 
         // --- Getters and Setters ---
 
-        // Returns the number of possible moves (the size of the policy vector).
+        // Returns the number of possible moves (the size of the policy, in either form).
         int getNumberOfMoves() const;
 
         // Gets the value of the state [-1, 1].
@@ -38,6 +50,23 @@ namespace scout
         // Returns a mutable reference to the policy vector (for modifying).
         std::vector<float> &getPolicy();
 
+        /**
+         * @brief Converts the policy to half precision once it has been evaluated, and
+         * releases the float vector: getPolicy() is then empty, and getPrior() reads the
+         * fp16 copy. Throws std::logic_error for more than GameState::NUM_MOVES moves.
+         */
+        void compact();
+        bool isCompact() const { return _compact; }
+
+        // The prior of `move`, from the float policy or its compact copy.
+        float getPrior(int move) const
+        {
+            return _compact ? fromFloat16(_compactPolicy[move]) : _policy[move];
+        }
+
+        // A zero value and a zero float policy, re-creating the vector of a compact evaluation.
+        void reset();
+
         // --- Utilities ---
 
         // Creates a string representation of the object.
@@ -54,6 +83,11 @@ namespace scout
 
         // A value in the range [-1, 1] indicating how favorable the state is.
         float _value;
+
+        // The policy in fp16 after compact(), and its size.
+        std::array<std::uint16_t, GameState::NUM_MOVES> _compactPolicy{};
+        std::uint8_t _compactMoves = 0;
+        bool _compact = false;
     };
 
     // Enables printing to std::ostream (e.g., std::cout << my_eval;).
@@ -75,6 +109,12 @@ namespace scout
         // Gets the calculated average value for a specific player.
         float getValue(Player player) const;
 
+        // Gets the number of samples behind the average.
+        int getSupport() const;
+
+        // Gets the sum of the samples from Player ONE's perspective, the average's numerator.
+        float getPlayerOneTotal() const;
+
         // Sets the state from a single evaluation and returns a reference to self.
         AverageValue &fromEvaluation(Player currentPlayer, float evaluatedValue);
 
@@ -105,6 +145,8 @@ namespace scout
 
     // Forward-declare TreeNode to avoid include cycles
     class TreeNode;
+    class TranspositionTable;
+    class NodePool;
 
     // The Evaluator now works directly with TreeNode pointers.
     using Evaluator = std::function<void(const std::vector<TreeNode *> &)>;
@@ -134,7 +176,7 @@ namespace scout
     class TreeNode
     {
     public:
-        // Constructor takes ownership of the GameState object.
+        // Constructor takes ownership of the GameState object. Terminal states start out proven.
         TreeNode(std::unique_ptr<GameState> state, int numMoves);
 
         // Updates the node's statistics from a simulation result.
@@ -142,14 +184,96 @@ namespace scout
 
         /**
          * @brief Initializes child states and evaluates them using the provided evaluator.
+         * Children shared through `transpositions` are already evaluated and are passed
+         * to the evaluator as nullptr.
          * @return An optional AverageValue representing the combined value of all new children.
          */
-        std::optional<AverageValue> initChildren(const Evaluator &evaluator);
+        std::optional<AverageValue> initChildren(const Evaluator &evaluator,
+                                                 TranspositionTable *transpositions = nullptr, int depth = 0);
+
+        /**
+         * @brief Creates the child nodes without evaluating them.
+         * @param transpositions If set, a child whose position already has a node at the
+         *        same depth reuses that node instead of creating a new one.
+         * @param depth The depth of this node below the search root.
+         * @param pool If set, new children are taken from the pool instead of the heap.
+         * @return False if the node was already initialized.
+         */
+        bool createChildren(TranspositionTable *transpositions = nullptr, int depth = 0, NodePool *pool = nullptr);
+
+        // Appends one row per move, as initChildren() passes them to the evaluator: the
+        // child, or nullptr for illegal moves and for children shared through a table.
+        void appendChildRows(std::vector<TreeNode *> &rows) const;
+
+        // Appends the children created by createChildren() that need an evaluation,
+        // i.e. all children except those shared through a transposition table.
+        void appendNewChildren(std::vector<TreeNode *> &nodes) const;
+
+        /**
+         * @brief Sets each new child's value from its evaluation, as initChildren() does
+         * after running the evaluator. Shared children keep their statistics and only
+         * contribute their evaluation.
+         * @param compactPriors If set, each new child's policy is then stored in fp16.
+         * @return The combined value of all children.
+         */
+        AverageValue collectChildrenValue(bool compactPriors = false);
+
+        // Virtual loss counts simulations in flight through this node. Selection treats
+        // them as lost visits, so batched descents spread over different leaves.
+        void addVirtualLoss();
+        void removeVirtualLoss();
+        int getVirtualLoss() const;
+
+        // Set while the node's children wait for an evaluation that runs concurrently with
+        // selection; selection stops at such a node instead of descending into them.
+        void setAwaitingEvaluation(bool awaiting);
+        bool isAwaitingEvaluation() const;
+
+        /**
+         * @brief Tries to prove the node from its children, by minimax for the player to move:
+         * the node is a win if any child is a win for the mover, and otherwise a draw or a
+         * loss once every child is proven.
+         * @return True if the node is proven.
+         */
+        bool updateProof();
+
+        // The game result under perfect play, once proven; Player::NONE is a proven draw.
+        const std::optional<Player> &getProvenWinner() const;
+        bool isProven() const;
+
+        // Marks the node as solved outside the tree, e.g. by an exact endgame search.
+        void setProvenWinner(Player winner);
+
+        /**
+         * @brief Returns the move to play, or -1 if there are no children: a proven win if
+         * there is one, then the most visited move that isn't proven, or a proven draw in its
+         * place when that move's average value for the player to move is 0 or less, and a
+         * proven loss only if nothing else is left.
+         */
+        int getBestMove() const;
+
+        // Releases the children, turning the node back into an unexpanded leaf that keeps
+        // its own statistics and proof. Selection expands it again when it returns.
+        void pruneChildren();
+
+        // Excluded moves are skipped by selection, e.g. root moves that can no longer
+        // become the most visited one within the remaining budget.
+        void excludeMove(int move);
+        void clearExcludedMoves();
+        bool isMoveExcluded(int move) const;
+
+        // Dirichlet noise over the moves, which PUCT selection mixes into the priors.
+        // It is sampled when selection first passes through the node and then kept, so
+        // repeated selections see the same noise instead of drawing it every time.
+        bool hasPriorNoise() const;
+        const std::array<float, GameState::NUM_MOVES> &getPriorNoise() const;
+        void setPriorNoise(const std::array<float, GameState::NUM_MOVES> &noise);
 
         /**
          * @brief Encodes the node's stats into a format for ML training.
          * The first element is the node's value, followed by the normalized visit counts
-         * of its children (policy).
+         * of its children (policy). A proven node encodes its exact result instead, with
+         * all of the policy on getBestMove().
          * @return A vector of floats representing the value and policy.
          */
         std::vector<float> encode() const;
@@ -158,22 +282,211 @@ namespace scout
         const GameState &state() const;
         StateEvaluation &evaluation();
         const StateEvaluation &evaluation() const;
-        const std::vector<std::unique_ptr<TreeNode>> &getChildStates() const;
+        const std::vector<std::shared_ptr<TreeNode>> &getChildStates() const;
         const Outcomes &getOutcomes() const;
         AverageValue &getAverageValue();
+        const AverageValue &getAverageValue() const;
         bool isInitialized() const;
         bool isLeaf() const;
         int getVisits() const;
         std::string toString() const;
 
     private:
+        friend class NodePool;
+        friend class TreeSnapshot;
+
+        // Turns a released node into a fresh, unexpanded node for `state`, keeping its buffers.
+        void reset(const GameState &state);
+
         std::unique_ptr<GameState> _state;
         StateEvaluation _evaluation;
         AverageValue _averageValue;
         Outcomes _outcomes;
-        // Child nodes are owned by this node.
-        std::vector<std::unique_ptr<TreeNode>> _childStates;
+        // Child nodes are owned by this node, and by any other parent that reached the
+        // same position through a transposition.
+        std::vector<std::shared_ptr<TreeNode>> _childStates;
+        // Bit i is set if child i was taken from a transposition table.
+        std::uint32_t _sharedChildren = 0;
+        // Bit i is set if move i was excluded from selection.
+        std::uint32_t _excludedMoves = 0;
+        std::array<float, GameState::NUM_MOVES> _priorNoise{};
+        bool _hasPriorNoise = false;
         bool _initialized = false;
+        bool _awaitingEvaluation = false;
+        int _virtualLoss = 0;
+        std::optional<Player> _provenWinner;
+    };
+
+    /**
+     * @brief Maps positions to the nodes already searched for them, turning the tree into a DAG.
+     *
+     * Nodes are keyed by their position and their depth below the search root, so a node
+     * is only shared by parents on the same level and the graph cannot contain cycles.
+     * The table doesn't keep nodes alive: entries of destroyed subtrees simply expire.
+     */
+    class TranspositionTable
+    {
+    public:
+        // Returns the live node stored for `state` at `depth`, or nullptr.
+        std::shared_ptr<TreeNode> find(const GameState &state, int depth);
+
+        // Stores `node` under its position at `depth`, replacing any previous entry.
+        void insert(const std::shared_ptr<TreeNode> &node, int depth);
+
+        void clear();
+        size_t size() const;
+
+        // Number of find() calls, and how many of them returned a node.
+        std::uint64_t getLookups() const { return lookups_; }
+        std::uint64_t getHits() const { return hits_; }
+
+    private:
+        struct Key
+        {
+            std::uint64_t hash;
+            int depth;
+            bool operator==(const Key &other) const { return hash == other.hash && depth == other.depth; }
+        };
+        struct KeyHash
+        {
+            size_t operator()(const Key &key) const
+            {
+                return static_cast<size_t>(key.hash ^ (static_cast<std::uint64_t>(key.depth) << 56));
+            }
+        };
+
+        std::unordered_map<Key, std::weak_ptr<TreeNode>, KeyHash> nodes_;
+        std::uint64_t lookups_ = 0;
+        std::uint64_t hits_ = 0;
+    };
+
+    /**
+     * @brief Recycles tree nodes, so that a search that keeps growing and discarding
+     * trees stops allocating once it has reached its largest tree, and optionally caps
+     * the memory a tree may use.
+     *
+     * Nodes handed out by acquire() return to the pool when their last owner lets go,
+     * with their state, policy and child buffers intact, and their children are released
+     * in turn. Nodes must not outlive the pool, and the pool is not thread-safe: give every
+     * thread its own.
+     *
+     * The shared_ptr control blocks come from a resource of the pool as well. A weak_ptr,
+     * such as a TranspositionTable entry, keeps its control block after the node is gone,
+     * so the resource outlives the pool for as long as any of its blocks are in use: a
+     * table may be cleared or destroyed before or after the pool.
+     */
+    class NodePool
+    {
+    public:
+        NodePool();
+        NodePool(const NodePool &) = delete;
+        NodePool &operator=(const NodePool &) = delete;
+        ~NodePool();
+
+        // An unexpanded node for `state`, reusing a released node if there is one.
+        std::shared_ptr<TreeNode> acquire(const GameState &state);
+
+        /**
+         * @brief Caps the bytes of the live nodes (0, the default, is no cap). Searches
+         * using the pool call prune() before every simulation, so a tree exceeds the cap
+         * by at most one expansion.
+         */
+        void setByteBudget(size_t bytes);
+        bool isOverBudget() const;
+
+        /**
+         * @brief Shrinks the tree below `root` to three quarters of the budget, if it is
+         * over budget, by pruning the subtrees with the fewest visits.
+         *
+         * Visits never grow along a path of a tree, so the nodes with at most a threshold
+         * of visits form whole subtrees far from the root; the pool picks the smallest
+         * threshold that frees enough nodes and turns the topmost such nodes back into
+         * leaves. They keep their statistics, so every node's visits and value stay as
+         * they were, the root's included. The root's children are never pruned away.
+         *
+         * With a transposition table, a child shared by several parents gathers visits
+         * from all of them and survives the pruning of any one. Only nodes owned by a
+         * single parent are counted towards the threshold and released; shared subtrees
+         * are freed only once every parent has let go of them, so a graph made mostly of
+         * transpositions may stay above the budget.
+         * @return The number of nodes released.
+         */
+        size_t prune(TreeNode &root);
+
+        // Nodes the pool has created in total, and how many of them are released right now.
+        size_t getCreatedNodes() const { return created_nodes_; }
+        size_t getFreeNodes() const { return free_nodes_.size(); }
+        size_t getLiveNodes() const { return created_nodes_ - free_nodes_.size(); }
+
+        // The bytes held by live nodes, as bytesPerNode() of the layout set below.
+        size_t getBytesInUse() const { return getLiveNodes() * bytesPerNode(compact_priors_); }
+
+        // Whether the nodes keep their priors in fp16, which the byte counter and the
+        // budget then account for. MonteCarloTreeSearch keeps it in step with its own setting.
+        void setCompactPriors(bool compact) { compact_priors_ = compact; }
+
+        // How often prune() shrank a tree, and the nodes it released in total.
+        std::uint64_t getPrunings() const { return prunings_; }
+        std::uint64_t getPrunedNodes() const { return pruned_nodes_; }
+
+        /**
+         * @brief The approximate footprint of one node: the node, its state, policy and
+         * child pointers, and its shared_ptr control block, without allocator overhead.
+         * A node with compact priors keeps its policy inside the node instead.
+         */
+        static constexpr size_t bytesPerNode(bool compactPriors = false)
+        {
+            return sizeof(TreeNode) + sizeof(GameState) + (compactPriors ? 0 : GameState::NUM_MOVES * sizeof(float)) +
+                   GameState::NUM_MOVES * sizeof(std::shared_ptr<TreeNode>) + CONTROL_BLOCK_BYTES;
+        }
+
+        // An estimate of a shared_ptr control block with a custom deleter and allocator.
+        static constexpr size_t CONTROL_BLOCK_BYTES = 4 * sizeof(void *);
+
+    private:
+        struct Recycler
+        {
+            NodePool *pool;
+            void operator()(TreeNode *node) const;
+        };
+
+        // The visits and child count of an expanded node, a pruning candidate.
+        struct Candidate
+        {
+            int visits;
+            int children;
+        };
+
+        // The control blocks' memory, which frees itself once the pool is gone and the
+        // last block has been returned.
+        class ControlBlocks : public std::pmr::memory_resource
+        {
+        public:
+            // Called by the pool's destructor instead of deleting the resource.
+            void orphan();
+
+        private:
+            void *do_allocate(size_t bytes, size_t alignment) override;
+            void do_deallocate(void *block, size_t bytes, size_t alignment) override;
+            bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+
+            std::pmr::unsynchronized_pool_resource blocks_;
+            size_t blocks_in_use_ = 0;
+            bool orphaned_ = false;
+        };
+
+        std::vector<TreeNode *> free_nodes_;
+        ControlBlocks *control_blocks_;
+        size_t created_nodes_ = 0;
+
+        size_t byte_budget_ = 0;
+        bool compact_priors_ = false;
+        std::uint64_t prunings_ = 0;
+        std::uint64_t pruned_nodes_ = 0;
+
+        // Buffers reused across prunings.
+        std::vector<Candidate> candidates_;
+        std::vector<TreeNode *> stack_;
     };
 
     /**
@@ -181,15 +494,23 @@ namespace scout
      *
      * This class is designed as a functor, meaning it can be used wherever a
      * scout::Evaluator (std::function) is expected.
+     *
+     * The input and output tensors live in buffers sized once for the largest batch, and
+     * states are encoded straight into them, so evaluating a batch doesn't allocate on our
+     * side. ONNX Runtime still creates small tensor handles per call and keeps its own
+     * intermediate buffers.
      */
     class OnnxEvaluator
     {
     public:
+        static constexpr size_t DEFAULT_MAX_BATCH_SIZE = 256;
+
         /**
-         * @brief Constructs the evaluator by loading an ONNX model from a file.
-         * @param model_path The filesystem path to the .onnx model file.
+         * @brief Constructs the evaluator from the embedded model.
+         * @param maxBatchSize The most rows passed to the model in one run; larger batches
+         *        are evaluated in several runs. Throws std::invalid_argument if zero.
          */
-        explicit OnnxEvaluator();
+        explicit OnnxEvaluator(size_t maxBatchSize = DEFAULT_MAX_BATCH_SIZE);
 
         /**
          * @brief The call operator that performs the evaluation.
@@ -199,14 +520,22 @@ namespace scout
         void operator()(const std::vector<TreeNode *> &nodes);
 
     private:
+        // Runs the model on nodes[first, first + count), with count at most max_batch_size_.
+        void evaluateRows(const std::vector<TreeNode *> &nodes, size_t first, size_t count);
+
         // ONNX Runtime environment and session.
         Ort::Env env_;
         Ort::Session session_;
         Ort::MemoryInfo memory_info_;
 
-        // Pre-allocated buffer for the input batch and its shape.
+        // Pre-allocated buffers for the largest batch, and the tensor shapes.
+        size_t max_batch_size_;
         std::vector<float> batch_input_;
+        std::vector<float> value_output_;
+        std::vector<float> policy_output_;
         std::vector<int64_t> input_shape_;
+        std::vector<int64_t> value_shape_;
+        std::vector<int64_t> policy_shape_;
 
         // Game constants derived from GameState.
         const size_t num_features_ = GameState::NUM_FEATURES;
@@ -218,7 +547,43 @@ namespace scout
         static constexpr const char *POLICY_OUTPUT_NAME = "policy_output";
     };
 
-    using ExpansionStrategy = std::function<int(const TreeNode &)>;
+    // Strategies may cache per-node data in the node, such as its prior noise.
+    using ExpansionStrategy = std::function<int(TreeNode &)>;
+
+    /**
+     * @brief The inputs of one PUCT selection, packed structure-of-arrays into float lanes.
+     *
+     * Lane i holds move i; the lanes past the last move stay zero. Gathering the children
+     * into these arrays is the only pointer chasing of a selection: scoring then runs over
+     * contiguous floats, four moves per vector instruction.
+     */
+    struct PackedChildren
+    {
+        // GameState::NUM_MOVES rounded up to whole 4-float vectors.
+        static constexpr int WIDTH = 12;
+        static_assert(WIDTH >= GameState::NUM_MOVES && WIDTH % 4 == 0);
+
+        alignas(16) float prior[WIDTH];
+        alignas(16) float noise[WIDTH];
+        alignas(16) float visits[WIDTH];
+        alignas(16) float value[WIDTH];
+        alignas(16) float support[WIDTH];
+        alignas(16) float virtualLoss[WIDTH];
+        // Bit i is set if move i may be selected.
+        std::uint32_t selectable;
+    };
+
+    /**
+     * @brief Scores every lane of `children` with the PUCT formula and returns the
+     * selectable lane with the highest score (the lowest one on ties), or -1 if no lane
+     * is selectable.
+     *
+     * The score is Q + explorationWeight * P * sqrt(N) / (1 + n + l), where P mixes the
+     * prior with noiseWeight of noise, N is `parentVisitsSqrt` squared, n the child's
+     * visits and l its virtual loss, which also counts as l lost visits in Q.
+     */
+    int selectPacked(const PackedChildren &children, float parentVisitsSqrt, float explorationWeight,
+                     float noiseWeight);
 
     /**
      * @brief A functor implementing the PUCT (Predictor + UCT) algorithm.
@@ -228,40 +593,681 @@ namespace scout
     class PredictiveUpperConfidenceBound
     {
     public:
+        // Seeds the noise generator from std::random_device.
         explicit PredictiveUpperConfidenceBound();
 
+        // Seeds the noise generator explicitly, e.g. to give parallel trees distinct streams.
+        explicit PredictiveUpperConfidenceBound(std::uint32_t seed);
+
+        // Restarts the noise stream from `seed`: the same seed, search and evaluator then
+        // grow the same tree and choose the same move, as for a new strategy.
+        void reseed(std::uint32_t seed) { random_generator_ = Xoshiro128(seed); }
+
         /**
          * @brief The call operator that makes this object a functor.
          * @param treeNode The current, initialized node whose children are considered.
-         * @return The index of the child node to move to.
+         *        Its prior noise is sampled on the first call for the node.
+         * @return The index of the child node to move to. Excluded children are skipped,
+         *         and so are proven children unless there is nothing else to select.
          */
-        int operator()(const TreeNode &treeNode);
+        int operator()(TreeNode &treeNode);
 
-    private:
-        std::vector<double> sampleDirichlet();
+        // A symmetric Dirichlet(1) sample over the moves: normalized Exponential(1) variates.
+        std::array<float, GameState::NUM_MOVES> sampleDirichlet();
 
+    private:
         static constexpr float EXPLORATION_WEIGHT = 4.0f;
         static constexpr float NOISE_WEIGHT = 0.25f;
 
-        size_t num_moves_ = GameState::NUM_MOVES;
-        std::mt19937 random_generator_;
-        std::gamma_distribution<double> gamma_distribution_;
+        Xoshiro128 random_generator_;
     };
 
-    class MonteCarloTreeSearch
+    // Evaluator calls are counted by their rows in power-of-two buckets, the same way
+    // wherever they are counted: bucket i holds calls with 2^i to 2^(i+1) - 1 rows, and
+    // the last bucket also takes everything larger.
+    constexpr int BATCH_SIZE_BUCKETS = 12;
+    using BatchSizeHistogram = std::array<std::uint64_t, BATCH_SIZE_BUCKETS>;
+
+    // The bucket of a call with `rows` rows; an empty call counts in the first one.
+    inline int batchSizeBucket(size_t rows)
+    {
+        return rows == 0 ? 0 : std::min(static_cast<int>(std::bit_width(rows)) - 1, BATCH_SIZE_BUCKETS - 1);
+    }
+
+    /**
+     * @brief What a search did and where its time went, for tuning and dashboards.
+     *
+     * The drivers count simulations and evaluator calls as they go, and the phase times
+     * only with detailed timing on; the tree size and the elapsed time are filled in by
+     * whoever runs the whole search.
+     */
+    struct SearchStats
+    {
+        std::uint64_t simulations = 0;
+        // Evaluator calls, and the rows (network evaluations) they carried in total.
+        std::uint64_t evaluatorCalls = 0;
+        std::uint64_t evaluatedRows = 0;
+        // Evaluator calls by their rows, see batchSizeBucket().
+        BatchSizeHistogram batchSizes{};
+        // Simulations that ended at a proven node, e.g. a finished game, without an expansion.
+        std::uint64_t terminalHits = 0;
+        // Simulations that backed up a leaf's own evaluation, below the expansion threshold.
+        std::uint64_t deferredExpansions = 0;
+        // Depth of the simulations' leaves below the root.
+        int maxDepth = 0;
+        std::uint64_t totalDepth = 0;
+        // The tree at the end of the search, see countNodes() and countBytes().
+        std::uint64_t nodes = 0;
+        std::uint64_t bytes = 0;
+
+        std::chrono::nanoseconds selectionTime{0};
+        std::chrono::nanoseconds expansionTime{0};
+        std::chrono::nanoseconds evaluationTime{0};
+        std::chrono::nanoseconds backpropagationTime{0};
+        std::chrono::microseconds elapsed{0};
+
+        double averageDepth() const;
+        double simulationsPerSecond() const;
+
+        // Counts one evaluator call with `rows` rows.
+        void recordBatch(size_t rows);
+
+        // Counts one simulation whose leaf was `depth` steps below the root.
+        void recordSimulation(int depth);
+
+        // Sums the counters, times and tree sizes; the larger depth and elapsed time win, as
+        // for trees searched side by side.
+        SearchStats &operator+=(const SearchStats &other);
+
+        std::string toString() const;
+    };
+
+    // --- Building blocks shared by MonteCarloTreeSearch and the other search drivers ---
+
+    // Limit on selection depth, guarding against cycles in the game graph.
+    constexpr int MAX_SELECTION_DEPTH = 200;
+
+    /**
+     * @brief Descends from `node` to a proven or unexpanded node, recording the path.
+     * The descent also stops after MAX_SELECTION_DEPTH steps, at an expanded node.
+     */
+    template <typename StrategyT>
+    void selectPath(TreeNode *node, StrategyT &strategy, std::vector<TreeNode *> &path);
+
+    // Updates every node on `path` with one simulation result, and propagates proofs upward
+    // from the leaf for as long as the nodes on the path become proven.
+    void backpropagate(const std::vector<TreeNode *> &path, Player winner, const AverageValue &value);
+
+    // Counts the nodes of the tree below `root`, the root included. A node shared through
+    // a transposition table counts once for every parent.
+    size_t countNodes(const TreeNode &root);
+
+    // The bytes held by the nodes of the tree below `root`, the root included, counting
+    // each node once: the node, its state, and the policy and child buffers it actually
+    // holds, so compact priors show, plus a shared_ptr control block. Allocator overhead
+    // is left out.
+    size_t countBytes(const TreeNode &root);
+
+    // The longest principal variation analyzeRoot() reports.
+    constexpr int MAX_PV_LENGTH = 32;
+
+    // One root move of a search, with what analysis tools show about it.
+    struct MoveAnalysis
+    {
+        int move = -1;
+        int visits = 0;
+        // The move's average value for the player to move at the root, in [-1, 1].
+        float value = 0.0f;
+        // The root's prior for the move.
+        float prior = 0.0f;
+        // The result under perfect play once the move is proven; Player::NONE is a draw.
+        std::optional<Player> provenWinner;
+        // The move, followed by getBestMove() of each node below it while there is one.
+        std::vector<int> principalVariation;
+    };
+
+    /**
+     * @brief Reports the `lines` best root moves of a searched tree, best first, in the
+     * order TreeNode::getBestMove() ranks them: proven wins, then the moves that aren't
+     * proven and the proven draws, with the draws first unless the most visited unproven
+     * move is worth more than 0, then proven losses, by visits within each group.
+     */
+    std::vector<MoveAnalysis> analyzeRoot(const TreeNode &root, int lines);
+
+    /**
+     * @brief Leaves that BasicMonteCarloTreeSearch::collectBatch() selected, whose new
+     * children wait for one evaluator call before backUpBatch() backs them up.
+     */
+    struct LeafBatch
+    {
+        // The paths from the root to the leaves; the first `leaves` are in use.
+        std::vector<std::vector<TreeNode *>> paths;
+        int leaves = 0;
+        // The new children of all the leaves: the rows to evaluate.
+        std::vector<TreeNode *> rows;
+    };
+
+    /**
+     * @brief The search driver, templated on the selection strategy and the evaluator.
+     *
+     * With concrete types (e.g. std::reference_wrapper<PredictiveUpperConfidenceBound>
+     * and ZeroValueUniformEvaluator), selection and evaluation are direct calls that the
+     * compiler can inline. MonteCarloTreeSearch is the type-erased instantiation over
+     * std::function, for callers that choose strategies and evaluators at run time.
+     */
+    template <typename StrategyT, typename EvaluatorT>
+    class BasicMonteCarloTreeSearch
     {
     public:
-        // The constructor now takes the strategy by value
-        MonteCarloTreeSearch(ExpansionStrategy strategy, Evaluator evaluator);
+        BasicMonteCarloTreeSearch(StrategyT strategy, EvaluatorT evaluator);
 
+        // Runs one simulation: selection, expansion with one evaluator call, backpropagation.
+        // Does nothing once the root is proven, so callers may stop searching early.
         void expand(TreeNode *rootNode);
 
+        /**
+         * @brief Runs one simulation through the given root move, which must exist (the
+         * root must be initialized). Root policies other than the strategy, such as
+         * GumbelSearch, use it to decide themselves how the root's visits are spread.
+         */
+        void expandChild(TreeNode *rootNode, int move);
+
+        /**
+         * @brief Runs up to `batchSize` simulations that share one evaluator call.
+         *
+         * Descends `batchSize` times with virtual loss, collecting distinct leaves, then
+         * evaluates the children of all of them in a single batch (about 9 rows per leaf)
+         * and backs every result up. Descents that end in a leaf already collected for
+         * this batch are abandoned, so a batch may hold fewer leaves than requested.
+         * @return The number of simulations backed up, 0 once the root is proven.
+         */
+        int expandBatch(TreeNode *rootNode, int batchSize);
+
+        /**
+         * @brief The selection and expansion half of expandBatch(), for callers that
+         * evaluate `batch.rows` themselves, e.g. on another thread while they collect the
+         * next batch. The leaves keep their virtual loss and are awaiting evaluation until
+         * backUpBatch(), so no later descent enters their unevaluated children. Unlike
+         * expandBatch(), it doesn't prune the tree, which may hold batches in flight.
+         * @return The simulations already backed up, for leaves that needed no evaluation.
+         */
+        int collectBatch(TreeNode *rootNode, int batchSize, LeafBatch &batch);
+
+        // Backs up a collected batch once its rows are evaluated; returns the simulations.
+        int backUpBatch(LeafBatch &batch);
+
+        /**
+         * @brief Shares nodes of identical positions through `transpositions` (nullptr
+         * disables sharing). The table must outlive the searches that use it and should
+         * only be used with trees grown from the same root.
+         *
+         * Backpropagation follows the path a simulation actually took, so a shared node
+         * is updated exactly once per simulation through it, whichever parent led there.
+         */
+        void setTranspositionTable(TranspositionTable *transpositions);
+
+        // Takes new nodes from `pool` (nullptr allocates them), and keeps the trees within
+        // the pool's byte budget. The pool must outlive the trees.
+        void setNodePool(NodePool *pool);
+
+        // Stores the priors of new nodes in fp16 once they are evaluated (off by default),
+        // see StateEvaluation::compact(). The node pool, if any, counts their bytes accordingly.
+        void setCompactPriors(bool compact);
+
+        /**
+         * @brief Expands a leaf below the root only once it has `visits` visits (0, the
+         * default, expands it on its first). Until then a simulation ending at the leaf
+         * backs up the leaf's own evaluation, from when its parent was expanded, so
+         * leaves that are rarely revisited never cost a batch of children's rows.
+         * Throws std::invalid_argument for a negative threshold.
+         */
+        void setExpansionThreshold(int visits);
+
+        /**
+         * @brief Times the selection, expansion, evaluation and backpropagation phases
+         * into the stats (off by default). That reads the clock several times per
+         * simulation, which costs a JS call per read in the browser, so the phase times
+         * stay zero unless it's on; the counters are always kept.
+         */
+        void setDetailedTiming(bool enabled) { detailed_timing_ = enabled; }
+
+        // The counters and phase times of every simulation since the last resetStats().
+        const SearchStats &getStats() const { return stats_; }
+        void resetStats() { stats_ = SearchStats(); }
+
     private:
-        // The member is now a std::function, not a unique_ptr
-        ExpansionStrategy expansion_strategy_;
-        Evaluator evaluator_;
+        // Expands the leaf at the end of `path` (if it's not proven) and backs the result up.
+        void simulate(const std::vector<TreeNode *> &path);
+
+        // True if the unexpanded leaf of `path` is valued by its own evaluation instead.
+        bool defersExpansion(const std::vector<TreeNode *> &path) const
+        {
+            const TreeNode *leaf = path.back();
+            return path.size() > 1 && !leaf->isInitialized() && leaf->getVisits() < expansion_threshold_;
+        }
+
+        // The time now with detailed timing on, else a fixed time point, so that the
+        // phase times add up to zero without reading the clock.
+        std::chrono::steady_clock::time_point phaseClock() const
+        {
+            return detailed_timing_ ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+        }
+
+        StrategyT expansion_strategy_;
+        EvaluatorT evaluator_;
+        TranspositionTable *transpositions_ = nullptr;
+        NodePool *nodes_ = nullptr;
+        bool compact_priors_ = false;
+        int expansion_threshold_ = 0;
+        bool detailed_timing_ = false;
+        SearchStats stats_;
+
+        // Buffers reused across calls.
+        std::vector<TreeNode *> path_;
+        LeafBatch batch_;
+        std::vector<TreeNode *> batch_nodes_;
     };
 
+    using MonteCarloTreeSearch = BasicMonteCarloTreeSearch<ExpansionStrategy, Evaluator>;
+
+    // --- Inline definitions, so that static dispatch can inline them ---
+
+    inline void ZeroValueUniformEvaluator::operator()(const std::vector<TreeNode *> &nodes) const
+    {
+        for (TreeNode *node : nodes)
+        {
+            // Skip null pointers or nodes representing a completed game.
+            if (node == nullptr || node->state().isGameOver())
+            {
+                continue;
+            }
+
+            // Set the value to a neutral 0.
+            node->evaluation().setValue(0.0f);
+
+            // Get a mutable reference to the policy vector.
+            std::vector<float> &policy = node->evaluation().getPolicy();
+
+            // Fill the entire policy vector with the pre-calculated uniform value.
+            // This is the C++ equivalent of Java's Arrays.fill().
+            std::fill(policy.begin(), policy.end(), _policyValue);
+        }
+    }
+
+    inline int selectPacked(const PackedChildren &children, float parentVisitsSqrt, float explorationWeight,
+                            float noiseWeight)
+    {
+        // GCC and Clang vector extensions: SSE on x86, NEON on ARM, and WebAssembly SIMD
+        // when Emscripten builds with -msimd128 (scalar code otherwise).
+        typedef float Lanes __attribute__((vector_size(16)));
+        constexpr int LANES = 4;
+        auto load = [](const float *lanes)
+        {
+            Lanes vector;
+            std::memcpy(&vector, lanes, sizeof(vector));
+            return vector;
+        };
+
+        alignas(16) float scores[PackedChildren::WIDTH];
+        for (int lane = 0; lane < PackedChildren::WIDTH; lane += LANES)
+        {
+            const Lanes prior = load(children.prior + lane);
+            const Lanes noise = load(children.noise + lane);
+            const Lanes visits = load(children.visits + lane);
+            const Lanes value = load(children.value + lane);
+            const Lanes support = load(children.support + lane);
+            const Lanes virtual_loss = load(children.virtualLoss + lane);
+
+            const Lanes adjusted_prior = prior * (1.0f - noiseWeight) + noise * noiseWeight;
+            const Lanes exploration = adjusted_prior * parentVisitsSqrt / (1.0f + visits + virtual_loss);
+            // (q * s - l) / (s + l), rewritten so that it is exactly q without virtual loss.
+            // The smallest normal float only keeps 0 / 0 away and vanishes next to s + l >= 1.
+            const Lanes exploitation = value - virtual_loss * (value + 1.0f) /
+                                                   (support + virtual_loss + std::numeric_limits<float>::min());
+            const Lanes score = exploitation + explorationWeight * exploration;
+            std::memcpy(scores + lane, &score, sizeof(score));
+        }
+
+        float max_score = -std::numeric_limits<float>::max();
+        int index_of_max = -1;
+        for (std::uint32_t bits = children.selectable; bits != 0; bits &= bits - 1)
+        {
+            const int move = std::countr_zero(bits);
+            if (scores[move] > max_score)
+            {
+                max_score = scores[move];
+                index_of_max = move;
+            }
+        }
+        return index_of_max;
+    }
+
+    inline int PredictiveUpperConfidenceBound::operator()(TreeNode &treeNode)
+    {
+        if (!treeNode.isInitialized())
+        {
+            throw std::logic_error("State node is not initialized!");
+        }
+        if (treeNode.isLeaf())
+        {
+            throw std::logic_error("State node is a leaf!");
+        }
+
+        if (!treeNode.hasPriorNoise())
+        {
+            treeNode.setPriorNoise(sampleDirichlet());
+        }
+
+        PackedChildren packed{};
+        // Used when every child is proven, which the parent learns by visiting one of them.
+        int first_proven = -1;
+
+        const auto &children = treeNode.getChildStates();
+        const StateEvaluation &evaluation = treeNode.evaluation();
+        const auto &noise = treeNode.getPriorNoise();
+        const Player player = treeNode.state().getCurrentPlayer();
+
+        for (size_t i = 0; i < children.size(); ++i)
+        {
+            TreeNode *child_state = children[i].get();
+            if (child_state == nullptr || treeNode.isMoveExcluded(i))
+            {
+                continue;
+            }
+            if (child_state->isProven())
+            {
+                // Searching a proven subtree can't change its result.
+                if (first_proven == -1)
+                {
+                    first_proven = i;
+                }
+                continue;
+            }
+
+            packed.selectable |= 1u << i;
+            packed.prior[i] = evaluation.getPrior(i);
+            packed.noise[i] = noise[i];
+            packed.visits[i] = static_cast<float>(child_state->getVisits());
+            packed.value[i] = child_state->getAverageValue().getValue(player);
+            packed.support[i] = static_cast<float>(child_state->getAverageValue().getSupport());
+            // Simulations in flight through the child count as visits that were lost.
+            packed.virtualLoss[i] = static_cast<float>(child_state->getVirtualLoss());
+        }
+
+        const float parent_visits_sqrt =
+            std::sqrt(static_cast<float>(1 + treeNode.getVisits() + treeNode.getVirtualLoss()));
+        int index_of_max = selectPacked(packed, parent_visits_sqrt, EXPLORATION_WEIGHT, NOISE_WEIGHT);
+
+        if (index_of_max == -1)
+        {
+            index_of_max = first_proven;
+        }
+        if (index_of_max == -1)
+        {
+            throw std::runtime_error("Could not find any valid child states.");
+        }
+
+        return index_of_max;
+    }
+
+    template <typename StrategyT>
+    void selectPath(TreeNode *node, StrategyT &strategy, std::vector<TreeNode *> &path)
+    {
+        path.clear();
+        path.push_back(node);
+
+        // Traverse the tree until a proven (e.g. terminal) or unexpanded node is found.
+        while (node->isInitialized() && !node->isProven() && !node->isAwaitingEvaluation() &&
+               static_cast<int>(path.size()) <= MAX_SELECTION_DEPTH)
+        {
+            int move_idx = strategy(*node);
+            node = node->getChildStates()[move_idx].get();
+            path.push_back(node);
+        }
+    }
+
+    template <typename StrategyT, typename EvaluatorT>
+    BasicMonteCarloTreeSearch<StrategyT, EvaluatorT>::BasicMonteCarloTreeSearch(StrategyT strategy, EvaluatorT evaluator)
+        : expansion_strategy_(std::move(strategy)),
+          evaluator_(std::move(evaluator)) {}
+
+    template <typename StrategyT, typename EvaluatorT>
+    void BasicMonteCarloTreeSearch<StrategyT, EvaluatorT>::setTranspositionTable(TranspositionTable *transpositions)
+    {
+        transpositions_ = transpositions;
+    }
+
+    template <typename StrategyT, typename EvaluatorT>
+    void BasicMonteCarloTreeSearch<StrategyT, EvaluatorT>::setNodePool(NodePool *pool)
+    {
+        nodes_ = pool;
+        if (nodes_ != nullptr)
+        {
+            nodes_->setCompactPriors(compact_priors_);
+        }
+    }
+
+    template <typename StrategyT, typename EvaluatorT>
+    void BasicMonteCarloTreeSearch<StrategyT, EvaluatorT>::setCompactPriors(bool compact)
+    {
+        compact_priors_ = compact;
+        if (nodes_ != nullptr)
+        {
+            nodes_->setCompactPriors(compact_priors_);
+        }
+    }
+
+    template <typename StrategyT, typename EvaluatorT>
+    void BasicMonteCarloTreeSearch<StrategyT, EvaluatorT>::setExpansionThreshold(int visits)
+    {
+        if (visits < 0)
+        {
+            throw std::invalid_argument("Expansion threshold must not be negative.");
+        }
+        expansion_threshold_ = visits;
+    }
+
+    template <typename StrategyT, typename EvaluatorT>
+    void BasicMonteCarloTreeSearch<StrategyT, EvaluatorT>::expand(TreeNode *rootNode)
+    {
+        if (!rootNode || rootNode->isProven())
+            return;
+
+        if (nodes_ != nullptr)
+        {
+            nodes_->prune(*rootNode);
+        }
+        const auto start = phaseClock();
+        selectPath(rootNode, expansion_strategy_, path_);
+        stats_.selectionTime += phaseClock() - start;
+        simulate(path_);
+    }
+
+    template <typename StrategyT, typename EvaluatorT>
+    void BasicMonteCarloTreeSearch<StrategyT, EvaluatorT>::expandChild(TreeNode *rootNode, int move)
+    {
+        TreeNode *child = rootNode->getChildStates().at(move).get();
+        if (child == nullptr)
+        {
+            throw std::invalid_argument("The root has no child for this move.");
+        }
+
+        if (nodes_ != nullptr)
+        {
+            nodes_->prune(*rootNode);
+        }
+        const auto start = phaseClock();
+        selectPath(child, expansion_strategy_, path_);
+        path_.insert(path_.begin(), rootNode);
+        stats_.selectionTime += phaseClock() - start;
+        simulate(path_);
+    }
+
+    template <typename StrategyT, typename EvaluatorT>
+    int BasicMonteCarloTreeSearch<StrategyT, EvaluatorT>::expandBatch(TreeNode *rootNode, int batchSize)
+    {
+        if (!rootNode || rootNode->isProven())
+            return 0;
+
+        if (nodes_ != nullptr)
+        {
+            nodes_->prune(*rootNode);
+        }
+
+        int simulations = collectBatch(rootNode, batchSize, batch_);
+        if (!batch_.rows.empty())
+        {
+            const auto start = phaseClock();
+            evaluator_(batch_.rows);
+            stats_.evaluationTime += phaseClock() - start;
+        }
+        simulations += backUpBatch(batch_);
+        return simulations;
+    }
+
+    template <typename StrategyT, typename EvaluatorT>
+    int BasicMonteCarloTreeSearch<StrategyT, EvaluatorT>::collectBatch(TreeNode *rootNode, int batchSize, LeafBatch &batch)
+    {
+        batch.leaves = 0;
+        batch.rows.clear();
+        if (!rootNode || rootNode->isProven())
+            return 0;
+
+        if (static_cast<int>(batch.paths.size()) < batchSize)
+        {
+            batch.paths.resize(batchSize);
+        }
+
+        using Clock = std::chrono::steady_clock;
+        int simulations = 0;
+
+        // 1. SELECTION: Descend with virtual loss until the batch is full.
+        for (int attempt = 0; attempt < batchSize && !rootNode->isProven(); ++attempt)
+        {
+            auto &path = batch.paths[batch.leaves];
+            const Clock::time_point start = phaseClock();
+            selectPath(rootNode, expansion_strategy_, path);
+            stats_.selectionTime += phaseClock() - start;
+            TreeNode *leaf = path.back();
+
+            // The leaf is already waiting in this batch, or in one still being evaluated.
+            if (leaf->isAwaitingEvaluation())
+            {
+                continue;
+            }
+
+            // Proven nodes, leaves below the expansion threshold (and the depth limit)
+            // need no evaluation; back them up now.
+            if (leaf->isInitialized() || leaf->isProven() || defersExpansion(path))
+            {
+                simulate(path);
+                ++simulations;
+                continue;
+            }
+
+            for (TreeNode *node : path)
+            {
+                node->addVirtualLoss();
+            }
+            leaf->setAwaitingEvaluation(true);
+            ++batch.leaves;
+        }
+
+        // 2. EXPANSION: Children are created only now, so that no descent above could
+        // wander into children that have not been evaluated yet.
+        const Clock::time_point expansion_start = phaseClock();
+        for (int i = 0; i < batch.leaves; ++i)
+        {
+            TreeNode *leaf = batch.paths[i].back();
+            leaf->createChildren(transpositions_, static_cast<int>(batch.paths[i].size()) - 1, nodes_);
+            leaf->appendNewChildren(batch.rows);
+        }
+        stats_.expansionTime += phaseClock() - expansion_start;
+        if (!batch.rows.empty())
+        {
+            stats_.recordBatch(batch.rows.size());
+        }
+        return simulations;
+    }
+
+    template <typename StrategyT, typename EvaluatorT>
+    int BasicMonteCarloTreeSearch<StrategyT, EvaluatorT>::backUpBatch(LeafBatch &batch)
+    {
+        // 3. BACKPROPAGATION
+        const auto start = phaseClock();
+        for (int i = 0; i < batch.leaves; ++i)
+        {
+            const auto &path = batch.paths[i];
+            for (TreeNode *node : path)
+            {
+                node->removeVirtualLoss();
+            }
+            TreeNode *leaf = path.back();
+            leaf->setAwaitingEvaluation(false);
+            backpropagate(path, leaf->state().getCurrentPlayer(), leaf->collectChildrenValue(compact_priors_));
+            stats_.recordSimulation(static_cast<int>(path.size()) - 1);
+        }
+        stats_.backpropagationTime += phaseClock() - start;
+
+        const int simulations = batch.leaves;
+        batch.leaves = 0;
+        batch.rows.clear();
+        return simulations;
+    }
+
+    template <typename StrategyT, typename EvaluatorT>
+    void BasicMonteCarloTreeSearch<StrategyT, EvaluatorT>::simulate(const std::vector<TreeNode *> &path)
+    {
+        using Clock = std::chrono::steady_clock;
+        TreeNode *leaf = path.back();
+        AverageValue accumulated_value;
+        Player winner = Player::NONE;
+        stats_.recordSimulation(static_cast<int>(path.size()) - 1);
+
+        const Clock::time_point expansion_start = phaseClock();
+        if (leaf->isProven())
+        {
+            // The simulation result is the game result under perfect play.
+            winner = leaf->getProvenWinner().value();
+            accumulated_value.addWinner(winner);
+            ++stats_.terminalHits;
+        }
+        else if (defersExpansion(path))
+        {
+            // The leaf's own evaluation stands in for those of its children.
+            winner = leaf->state().getCurrentPlayer();
+            accumulated_value.fromEvaluation(winner, leaf->evaluation().getValue());
+            ++stats_.deferredExpansions;
+        }
+        else if (leaf->createChildren(transpositions_, static_cast<int>(path.size()) - 1, nodes_))
+        {
+            // The same rows as TreeNode::initChildren(), without a std::function call.
+            batch_nodes_.clear();
+            leaf->appendChildRows(batch_nodes_);
+            const Clock::time_point evaluation_start = phaseClock();
+            evaluator_(batch_nodes_);
+            const Clock::time_point evaluation_end = phaseClock();
+            stats_.recordBatch(batch_nodes_.size());
+            stats_.evaluationTime += evaluation_end - evaluation_start;
+            stats_.expansionTime -= evaluation_end - evaluation_start;
+
+            // The simulation result is the neural network evaluation of the new children.
+            // The "winner" in this case isn't a game win, but the perspective for the value.
+            // We use the player whose turn it was at the expanded node.
+            accumulated_value = leaf->collectChildrenValue(compact_priors_);
+            winner = leaf->state().getCurrentPlayer();
+        }
+        // Otherwise the depth limit was hit: back up a tie with no value.
+
+        const Clock::time_point backpropagation_start = phaseClock();
+        stats_.expansionTime += backpropagation_start - expansion_start;
+        backpropagate(path, winner, accumulated_value);
+        stats_.backpropagationTime += phaseClock() - backpropagation_start;
+    }
+
+    // Instantiated once, in mcts.cc.
+    extern template class BasicMonteCarloTreeSearch<ExpansionStrategy, Evaluator>;
+
 } // namespace scout
 
 #endif // WASM_SCOUT_LIB_MCTS_H
\ No newline at end of file
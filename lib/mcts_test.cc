@@ -1,6 +1,11 @@
 #include "lib/mcts.h"
 
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <iostream>
+#include <limits>
+#include <random>
 
 #include "gtest/gtest.h"
 
@@ -105,6 +110,33 @@ namespace scout
         // EXPECT_NE(eval1, eval5);
     }
 
+    TEST(StateEvaluationTest, CompactKeepsThePolicyInHalfPrecision)
+    {
+        StateEvaluation eval(3);
+        eval.setValue(0.5f);
+        eval.getPolicy() = {0.1f, 0.25f, 0.65f};
+        const StateEvaluation original = eval;
+
+        eval.compact();
+        EXPECT_TRUE(eval.isCompact());
+        EXPECT_TRUE(eval.getPolicy().empty());
+        EXPECT_EQ(eval.getNumberOfMoves(), 3);
+        EXPECT_EQ(eval.getValue(), 0.5f);
+        EXPECT_EQ(eval.getPrior(1), 0.25f);
+        for (int move = 0; move < 3; ++move)
+        {
+            EXPECT_NEAR(eval.getPrior(move), original.getPrior(move), 1e-3f);
+        }
+
+        // A reset evaluation is a float one again, ready for the evaluator.
+        eval.reset();
+        EXPECT_FALSE(eval.isCompact());
+        EXPECT_EQ(eval, StateEvaluation(3));
+
+        StateEvaluation too_large(GameState::NUM_MOVES + 1);
+        EXPECT_THROW(too_large.compact(), std::logic_error);
+    }
+
     // --- Tests for AverageValue ---
     // These tests use the real Player enum from game.h.
 
@@ -414,11 +446,14 @@ namespace scout
 
         // --- 3. ASSERT: Verify the results ---
 
-        // ✅ The root node should have been visited in every single expansion.
-        ASSERT_EQ(root_node.getVisits(), num_expansions);
+        // ✅ Move 8 wins on the spot, so the first expansion proves the root and the
+        // remaining expansions do nothing.
+        ASSERT_TRUE(root_node.isProven());
+        ASSERT_EQ(root_node.getProvenWinner(), Player::ONE);
+        ASSERT_EQ(root_node.getVisits(), 1);
 
         // ✅ The total number of outcomes (win/loss/tie) recorded should also match.
-        ASSERT_EQ(root_node.getOutcomes().getTotalOutcomes(), num_expansions);
+        ASSERT_EQ(root_node.getOutcomes().getTotalOutcomes(), 1);
 
         auto encoded = root_node.encode();
         std::cout << "Encoded: [";
@@ -428,7 +463,7 @@ namespace scout
         }
         std::cout << "] ";
 
-        const std::vector<float> expected_encoded = {0.8751, 0.014, 0.014, 0.0164, 0.0149, 0.0159, 0.0164, 0.013, 0.03, 0.86};
+        const std::vector<float> expected_encoded = {1, 0, 0, 0, 0, 0, 0, 0, 0, 1};
 
         ASSERT_EQ(encoded.size(), expected_encoded.size());
         for (size_t i = 0; i < expected_encoded.size(); ++i)
@@ -436,4 +471,786 @@ namespace scout
             ASSERT_NEAR(encoded[i], expected_encoded[i], 0.01);
         }
     }
+
+    TEST(MonteCarloTreeSearchTest, CollectBatchStopsAtLeavesInFlight)
+    {
+        PredictiveUpperConfidenceBound pucb_strategy(1);
+        ZeroValueUniformEvaluator uniform(GameState::NUM_MOVES);
+        MonteCarloTreeSearch mcts(std::ref(pucb_strategy), uniform);
+        TreeNode root(std::make_unique<GameState>(), GameState::NUM_MOVES);
+        for (int i = 0; i < 50; ++i)
+        {
+            mcts.expand(&root);
+        }
+
+        // The first batch is collected but not evaluated when the second one is selected.
+        LeafBatch first;
+        LeafBatch second;
+        EXPECT_EQ(mcts.collectBatch(&root, 8, first), 0);
+        ASSERT_GT(first.leaves, 0);
+        EXPECT_EQ(mcts.collectBatch(&root, 8, second), 0);
+        ASSERT_GT(second.leaves, 0);
+        for (int i = 0; i < first.leaves; ++i)
+        {
+            TreeNode *leaf = first.paths[i].back();
+            EXPECT_TRUE(leaf->isAwaitingEvaluation());
+            for (int j = 0; j < second.leaves; ++j)
+            {
+                // No descent of the second batch reached or passed a leaf of the first.
+                const auto &path = second.paths[j];
+                EXPECT_EQ(std::count(path.begin(), path.end(), leaf), 0);
+            }
+        }
+
+        const int first_leaves = first.leaves;
+        const int second_leaves = second.leaves;
+        uniform(first.rows);
+        EXPECT_EQ(mcts.backUpBatch(first), first_leaves);
+        uniform(second.rows);
+        EXPECT_EQ(mcts.backUpBatch(second), second_leaves);
+
+        // Everything was backed up and no virtual loss is left behind.
+        EXPECT_EQ(root.getVisits(), 50 + first_leaves + second_leaves);
+        EXPECT_EQ(root.getVirtualLoss(), 0);
+        for (const auto &child : root.getChildStates())
+        {
+            if (child != nullptr)
+            {
+                EXPECT_EQ(child->getVirtualLoss(), 0);
+                EXPECT_FALSE(child->isAwaitingEvaluation());
+            }
+        }
+    }
+
+    TEST(MonteCarloTreeSearchTest, ExpandBatchCollectsDistinctLeaves)
+    {
+        ZeroValueUniformEvaluator uniform(GameState::NUM_MOVES);
+        int evaluator_calls = 0;
+        size_t largest_batch = 0;
+        Evaluator counting_evaluator = [&](const std::vector<TreeNode *> &nodes)
+        {
+            ++evaluator_calls;
+            largest_batch = std::max(largest_batch, nodes.size());
+            uniform(nodes);
+        };
+
+        PredictiveUpperConfidenceBound pucb_strategy(1);
+        MonteCarloTreeSearch mcts(std::ref(pucb_strategy), counting_evaluator);
+        TreeNode root(std::make_unique<GameState>(), GameState::NUM_MOVES);
+
+        // Every descent ends at the unexpanded root, so only one leaf can be collected.
+        EXPECT_EQ(mcts.expandBatch(&root, 8), 1);
+        EXPECT_EQ(evaluator_calls, 1);
+
+        // With the root expanded, virtual loss spreads the descents over its children.
+        // The root's prior noise is fixed once sampled, so a child it strongly favours
+        // can still attract a second descent, which is abandoned.
+        int simulations = mcts.expandBatch(&root, 8);
+        EXPECT_GT(simulations, 4);
+        EXPECT_LE(simulations, 8);
+        EXPECT_EQ(evaluator_calls, 2);
+
+        // The single call carried the children of every leaf it collected.
+        size_t expanded_leaves = 0;
+        size_t batched_children = 0;
+        for (const auto &child : root.getChildStates())
+        {
+            if (!child->isInitialized())
+            {
+                continue;
+            }
+            ++expanded_leaves;
+            for (const auto &grandchild : child->getChildStates())
+            {
+                batched_children += grandchild != nullptr;
+            }
+        }
+        EXPECT_EQ(expanded_leaves, static_cast<size_t>(simulations));
+        EXPECT_EQ(largest_batch, batched_children);
+
+        for (int i = 0; i < 50; ++i)
+        {
+            simulations += mcts.expandBatch(&root, 8);
+        }
+        EXPECT_EQ(root.getVisits(), 1 + simulations);
+        EXPECT_EQ(evaluator_calls, 52);
+
+        // All virtual loss has been removed again.
+        EXPECT_EQ(root.getVirtualLoss(), 0);
+        for (const auto &child : root.getChildStates())
+        {
+            EXPECT_EQ(child->getVirtualLoss(), 0);
+        }
+    }
+
+    TEST(MonteCarloTreeSearchTest, ExpandBatchFindsWinningMove)
+    {
+        PredictiveUpperConfidenceBound pucb_strategy(1);
+        MonteCarloTreeSearch mcts(std::ref(pucb_strategy), ZeroValueUniformEvaluator(GameState::NUM_MOVES));
+
+        auto root_state = std::make_unique<GameState>();
+        root_state = root_state->move(8)->move(1)->move(7)->move(3)->move(6)->move(3)->move(4)->move(1)->move(8)->move(8);
+        TreeNode root(std::move(root_state), GameState::NUM_MOVES);
+
+        int simulations = 0;
+        while (simulations < 2000 && !root.isProven())
+        {
+            simulations += mcts.expandBatch(&root, 16);
+        }
+
+        EXPECT_EQ(root.getVisits(), simulations);
+        auto encoded = root.encode();
+        EXPECT_EQ(std::max_element(encoded.begin() + 1, encoded.end()) - encoded.begin() - 1, 8);
+    }
+
+    TEST(MonteCarloTreeSearchTest, CompactPriorsFindWinningMove)
+    {
+        PredictiveUpperConfidenceBound pucb_strategy(1);
+        MonteCarloTreeSearch mcts(std::ref(pucb_strategy), ZeroValueUniformEvaluator(GameState::NUM_MOVES));
+        mcts.setCompactPriors(true);
+        NodePool pool;
+        mcts.setNodePool(&pool);
+
+        auto root_state = std::make_unique<GameState>();
+        root_state = root_state->move(8)->move(1)->move(7)->move(3)->move(6)->move(3)->move(4)->move(1)->move(8)->move(8);
+        for (int repeat = 0; repeat < 2; ++repeat)
+        {
+            // The second tree reuses the compact nodes of the first.
+            std::shared_ptr<TreeNode> root = pool.acquire(*root_state);
+            mcts.expand(root.get());
+            mcts.expandBatch(root.get(), 16);
+
+            EXPECT_EQ(root->getBestMove(), 8);
+            for (const auto &child : root->getChildStates())
+            {
+                if (child != nullptr)
+                {
+                    EXPECT_TRUE(child->evaluation().isCompact());
+                    // Finished games get no policy from the evaluator.
+                    const float prior = child->state().isGameOver() ? 0.0f : 1.0f / GameState::NUM_MOVES;
+                    EXPECT_NEAR(child->evaluation().getPrior(0), prior, 1e-4f);
+                }
+            }
+        }
+    }
+
+    TEST(MonteCarloTreeSearchTest, CompactPriorsShrinkTheCountedBytes)
+    {
+        size_t bytes[2];
+        size_t nodes[2];
+        for (int compact = 0; compact < 2; ++compact)
+        {
+            PredictiveUpperConfidenceBound pucb_strategy(1);
+            MonteCarloTreeSearch mcts(std::ref(pucb_strategy), ZeroValueUniformEvaluator(GameState::NUM_MOVES));
+            NodePool pool;
+            mcts.setNodePool(&pool);
+            // Set after the pool, which still follows it.
+            mcts.setCompactPriors(compact == 1);
+
+            std::shared_ptr<TreeNode> root = pool.acquire(GameState());
+            for (int i = 0; i < 200; ++i)
+            {
+                mcts.expand(root.get());
+            }
+            bytes[compact] = countBytes(*root);
+            nodes[compact] = countNodes(*root);
+            EXPECT_EQ(pool.getBytesInUse(), pool.getLiveNodes() * NodePool::bytesPerNode(compact == 1));
+        }
+
+        // The same seed grows the same tree, whose float policies are gone with compact priors.
+        ASSERT_EQ(nodes[0], nodes[1]);
+        EXPECT_EQ(bytes[0] - bytes[1], (nodes[0] - 1) * GameState::NUM_MOVES * sizeof(float));
+    }
+
+    TEST(MonteCarloTreeSearchTest, SolverProvesWinInOne)
+    {
+        PredictiveUpperConfidenceBound pucb_strategy(1);
+        MonteCarloTreeSearch mcts(std::ref(pucb_strategy), ZeroValueUniformEvaluator(GameState::NUM_MOVES));
+
+        auto root_state = std::make_unique<GameState>();
+        root_state = root_state->move(8)->move(1)->move(7)->move(3)->move(6)->move(3)->move(4)->move(1)->move(8)->move(8);
+        TreeNode root(std::move(root_state), GameState::NUM_MOVES);
+
+        mcts.expand(&root);
+        ASSERT_TRUE(root.isProven());
+        EXPECT_EQ(root.getProvenWinner(), Player::ONE);
+        EXPECT_TRUE(root.getChildStates()[8]->isProven());
+        EXPECT_EQ(root.getBestMove(), 8);
+
+        // A proven root is not searched any further.
+        mcts.expand(&root);
+        EXPECT_EQ(mcts.expandBatch(&root, 16), 0);
+        EXPECT_EQ(root.getVisits(), 1);
+
+        const std::vector<float> expected = {1, 0, 0, 0, 0, 0, 0, 0, 0, 1};
+        EXPECT_EQ(root.encode(), expected);
+    }
+
+    TEST(MonteCarloTreeSearchTest, SolverProvesLoss)
+    {
+        // Two plies before the end of a random game, the player to move has lost.
+        std::mt19937 random_generator(2);
+        std::vector<std::unique_ptr<GameState>> game;
+        game.push_back(std::make_unique<GameState>());
+        while (!game.back()->isGameOver())
+        {
+            std::vector<int> moves;
+            for (int move = 0; move < GameState::NUM_MOVES; ++move)
+            {
+                if (game.back()->isMoveAllowed(move))
+                {
+                    moves.push_back(move);
+                }
+            }
+            game.push_back(game.back()->move(moves[random_generator() % moves.size()]));
+        }
+        ASSERT_GE(game.size(), 3u);
+        const GameState &position = *game[game.size() - 3];
+        const Player mover = position.getCurrentPlayer();
+        const Player winner = game.back()->getWinner().value();
+        ASSERT_NE(winner, mover);
+
+        // Every move loses at once, or allows a winning reply.
+        for (int move = 0; move < GameState::NUM_MOVES; ++move)
+        {
+            if (!position.isMoveAllowed(move))
+            {
+                continue;
+            }
+            auto next = position.move(move);
+            bool lost = next->isGameOver() && next->getWinner() == winner;
+            for (int reply = 0; reply < GameState::NUM_MOVES && !lost && !next->isGameOver(); ++reply)
+            {
+                if (next->isMoveAllowed(reply) && next->getCurrentPlayer() == winner)
+                {
+                    auto after = next->move(reply);
+                    lost = after->isGameOver() && after->getWinner() == winner;
+                }
+            }
+            ASSERT_TRUE(lost) << "move " << move;
+        }
+
+        PredictiveUpperConfidenceBound pucb_strategy(1);
+        MonteCarloTreeSearch mcts(std::ref(pucb_strategy), ZeroValueUniformEvaluator(GameState::NUM_MOVES));
+        TreeNode root(std::make_unique<GameState>(position), GameState::NUM_MOVES);
+        int expansions = 0;
+        while (expansions < 2000 && !root.isProven())
+        {
+            mcts.expand(&root);
+            ++expansions;
+        }
+
+        ASSERT_TRUE(root.isProven());
+        EXPECT_EQ(root.getProvenWinner(), winner);
+        EXPECT_LT(expansions, 100);
+        EXPECT_FLOAT_EQ(root.encode()[0], -1.0f);
+    }
+
+    TEST(MonteCarloTreeSearchTest, StaticDispatchMatchesTypeErasedSearch)
+    {
+        auto search = [](auto &mcts)
+        {
+            auto root_state = std::make_unique<GameState>();
+            TreeNode root(root_state->move(8)->move(1)->move(7)->move(3), GameState::NUM_MOVES);
+            for (int i = 0; i < 500; ++i)
+            {
+                mcts.expand(&root);
+            }
+            return root.encode();
+        };
+
+        PredictiveUpperConfidenceBound dynamic_strategy(1);
+        MonteCarloTreeSearch dynamic_search(std::ref(dynamic_strategy), ZeroValueUniformEvaluator(GameState::NUM_MOVES));
+        PredictiveUpperConfidenceBound static_strategy(1);
+        BasicMonteCarloTreeSearch static_search(std::ref(static_strategy), ZeroValueUniformEvaluator(GameState::NUM_MOVES));
+
+        EXPECT_EQ(search(dynamic_search), search(static_search));
+    }
+
+    namespace
+    {
+        // Checks that every node below `node` was expanded on its (threshold + 1)th visit.
+        void expectExpandedAfterThreshold(const TreeNode &node, int threshold)
+        {
+            for (const auto &child : node.getChildStates())
+            {
+                if (child == nullptr || child->isProven())
+                {
+                    continue;
+                }
+                if (child->isInitialized())
+                {
+                    EXPECT_GT(child->getVisits(), threshold);
+                    expectExpandedAfterThreshold(*child, threshold);
+                }
+                else
+                {
+                    EXPECT_LE(child->getVisits(), threshold);
+                }
+            }
+        }
+    }
+
+    TEST(MonteCarloTreeSearchTest, ExpansionThresholdDefersExpansion)
+    {
+        const int simulations = 1000;
+        auto search = [](int threshold, bool batched)
+        {
+            PredictiveUpperConfidenceBound pucb_strategy(1);
+            MonteCarloTreeSearch mcts(std::ref(pucb_strategy), ZeroValueUniformEvaluator(GameState::NUM_MOVES));
+            mcts.setExpansionThreshold(threshold);
+            TreeNode root(GameState().move(8)->move(1)->move(7)->move(3), GameState::NUM_MOVES);
+            int done = 0;
+            while (done < simulations)
+            {
+                if (batched)
+                {
+                    done += mcts.expandBatch(&root, 8);
+                }
+                else
+                {
+                    mcts.expand(&root);
+                    ++done;
+                }
+            }
+
+            EXPECT_EQ(root.getVisits(), done);
+            EXPECT_TRUE(root.isInitialized());
+            expectExpandedAfterThreshold(root, threshold);
+            const SearchStats &stats = mcts.getStats();
+            EXPECT_EQ(stats.simulations, static_cast<std::uint64_t>(done));
+            return stats;
+        };
+
+        const SearchStats immediate = search(0, false);
+        EXPECT_EQ(immediate.deferredExpansions, 0u);
+        for (bool batched : {false, true})
+        {
+            const SearchStats deferred = search(2, batched);
+            EXPECT_GT(deferred.deferredExpansions, 0u);
+            // Fewer leaves are expanded, so the model sees fewer rows per simulation.
+            EXPECT_LT(deferred.evaluatedRows * 2, immediate.evaluatedRows);
+        }
+
+        PredictiveUpperConfidenceBound pucb_strategy(1);
+        MonteCarloTreeSearch mcts(std::ref(pucb_strategy), ZeroValueUniformEvaluator(GameState::NUM_MOVES));
+        EXPECT_THROW(mcts.setExpansionThreshold(-1), std::invalid_argument);
+    }
+
+    TEST(MonteCarloTreeSearchTest, SameSeedGrowsTheSameTree)
+    {
+        PredictiveUpperConfidenceBound pucb_strategy(11);
+        MonteCarloTreeSearch mcts(std::ref(pucb_strategy), ZeroValueUniformEvaluator(GameState::NUM_MOVES));
+        auto search = [&mcts]
+        {
+            auto root = std::make_unique<TreeNode>(GameState().move(8)->move(1)->move(7)->move(3), GameState::NUM_MOVES);
+            for (int i = 0; i < 1000; ++i)
+            {
+                mcts.expand(root.get());
+            }
+            return root;
+        };
+
+        const auto first = search();
+        pucb_strategy.reseed(11);
+        const auto second = search();
+        EXPECT_EQ(countNodes(*second), countNodes(*first));
+        EXPECT_EQ(second->encode(), first->encode());
+        EXPECT_EQ(second->getBestMove(), first->getBestMove());
+        for (int move = 0; move < GameState::NUM_MOVES; ++move)
+        {
+            const TreeNode *a = first->getChildStates()[move].get();
+            const TreeNode *b = second->getChildStates()[move].get();
+            ASSERT_EQ(a == nullptr, b == nullptr);
+            if (a != nullptr)
+            {
+                EXPECT_EQ(b->encode(), a->encode());
+            }
+        }
+
+        pucb_strategy.reseed(12);
+        EXPECT_NE(search()->encode(), first->encode());
+    }
+
+    namespace
+    {
+        // The scalar PUCT formula in double precision, as selection computed it before the
+        // packed kernel, for the lanes of `children`.
+        int scalarPuct(const PackedChildren &children, double parentVisitsSqrt, float explorationWeight,
+                       float noiseWeight, double *margin = nullptr)
+        {
+            double best = -std::numeric_limits<double>::max();
+            double second = best;
+            int best_move = -1;
+            for (int move = 0; move < GameState::NUM_MOVES; ++move)
+            {
+                if (!((children.selectable >> move) & 1u))
+                {
+                    continue;
+                }
+                const double prior = children.prior[move] * (1.0 - noiseWeight) + noiseWeight * children.noise[move];
+                const double virtual_loss = children.virtualLoss[move];
+                double exploitation = children.value[move];
+                if (virtual_loss > 0)
+                {
+                    const double support = children.support[move];
+                    exploitation = (exploitation * support - virtual_loss) / (support + virtual_loss);
+                }
+                const double score = exploitation + explorationWeight * prior * parentVisitsSqrt /
+                                                        (1.0 + children.visits[move] + virtual_loss);
+                if (score > best)
+                {
+                    second = best;
+                    best = score;
+                    best_move = move;
+                }
+                else if (score > second)
+                {
+                    second = score;
+                }
+            }
+            if (margin != nullptr)
+            {
+                *margin = best - second;
+            }
+            return best_move;
+        }
+
+        // The Dirichlet(1) noise as it was sampled before, from std::mt19937 and gamma variates.
+        std::array<float, GameState::NUM_MOVES> gammaDirichlet(std::mt19937 &generator)
+        {
+            std::gamma_distribution<double> gamma(1.0, 1.0);
+            std::array<double, GameState::NUM_MOVES> sample;
+            double sum = 0.0;
+            for (double &variate : sample)
+            {
+                variate = gamma(generator);
+                sum += variate;
+            }
+            std::array<float, GameState::NUM_MOVES> noise;
+            for (int move = 0; move < GameState::NUM_MOVES; ++move)
+            {
+                noise[move] = static_cast<float>(sample[move] / sum);
+            }
+            return noise;
+        }
+    }
+
+    TEST(PredictiveUpperConfidenceBoundTest, PackedKernelMatchesScalarFormula)
+    {
+        std::mt19937 generator(7);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        std::uniform_int_distribution<int> counts(0, 50);
+        std::uniform_int_distribution<int> losses(0, 3);
+
+        int compared = 0;
+        for (int trial = 0; trial < 10000; ++trial)
+        {
+            PackedChildren children{};
+            children.selectable = generator() & 0x1ffu;
+            int parent_visits = 0;
+            for (int move = 0; move < GameState::NUM_MOVES; ++move)
+            {
+                children.prior[move] = unit(generator);
+                children.noise[move] = unit(generator);
+                children.visits[move] = static_cast<float>(counts(generator));
+                children.support[move] = children.visits[move] + 1.0f;
+                children.value[move] = 2.0f * unit(generator) - 1.0f;
+                children.virtualLoss[move] = static_cast<float>(losses(generator));
+                parent_visits += static_cast<int>(children.visits[move]);
+            }
+
+            const float parent_visits_sqrt = std::sqrt(1.0f + parent_visits);
+            double margin = 0.0;
+            const int expected = scalarPuct(children, std::sqrt(1.0 + parent_visits), 4.0f, 0.25f, &margin);
+            // Single and double precision may order scores closer than float epsilon either way.
+            if (margin < 1e-4)
+            {
+                continue;
+            }
+            ++compared;
+            ASSERT_EQ(selectPacked(children, parent_visits_sqrt, 4.0f, 0.25f), expected) << "trial " << trial;
+        }
+        EXPECT_GT(compared, 9000);
+
+        PackedChildren none{};
+        EXPECT_EQ(selectPacked(none, 1.0f, 4.0f, 0.25f), -1);
+    }
+
+    TEST(PredictiveUpperConfidenceBoundTest, MoveChoicesMatchGammaNoiseInDistribution)
+    {
+        // Fixed child statistics; only the noise differs between selections.
+        PackedChildren children{};
+        children.selectable = 0x1ffu;
+        const float priors[] = {0.3f, 0.2f, 0.15f, 0.1f, 0.1f, 0.05f, 0.05f, 0.03f, 0.02f};
+        const float visits[] = {4, 2, 2, 1, 1, 0, 0, 0, 0};
+        const float values[] = {0.1f, 0.2f, -0.1f, 0.3f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+        for (int move = 0; move < GameState::NUM_MOVES; ++move)
+        {
+            children.prior[move] = priors[move];
+            children.visits[move] = visits[move];
+            children.value[move] = values[move];
+            children.support[move] = visits[move] + 1.0f;
+        }
+        const float parent_visits_sqrt = std::sqrt(11.0f);
+
+        constexpr int SAMPLES = 20000;
+        PredictiveUpperConfidenceBound pucb_strategy(3);
+        std::mt19937 generator(3);
+        std::array<int, GameState::NUM_MOVES> packed_choices{};
+        std::array<int, GameState::NUM_MOVES> reference_choices{};
+        for (int i = 0; i < SAMPLES; ++i)
+        {
+            const auto noise = pucb_strategy.sampleDirichlet();
+            std::copy(noise.begin(), noise.end(), children.noise);
+            ++packed_choices[selectPacked(children, parent_visits_sqrt, 4.0f, 0.25f)];
+
+            const auto reference_noise = gammaDirichlet(generator);
+            std::copy(reference_noise.begin(), reference_noise.end(), children.noise);
+            ++reference_choices[scalarPuct(children, std::sqrt(11.0), 4.0f, 0.25f)];
+        }
+
+        // Two-sample chi-squared test of homogeneity; 26.1 is the 0.999 quantile for 8
+        // degrees of freedom.
+        double chi_squared = 0.0;
+        for (int move = 0; move < GameState::NUM_MOVES; ++move)
+        {
+            const double total = packed_choices[move] + reference_choices[move];
+            if (total > 0)
+            {
+                const double difference = packed_choices[move] - reference_choices[move];
+                chi_squared += difference * difference / total;
+            }
+        }
+        EXPECT_LT(chi_squared, 26.1);
+    }
+
+    TEST(PredictiveUpperConfidenceBoundTest, NoiseIsSampledOncePerNode)
+    {
+        PredictiveUpperConfidenceBound pucb_strategy(1);
+        MonteCarloTreeSearch mcts(std::ref(pucb_strategy), ZeroValueUniformEvaluator(GameState::NUM_MOVES));
+        TreeNode root(std::make_unique<GameState>(), GameState::NUM_MOVES);
+
+        mcts.expand(&root);
+        EXPECT_FALSE(root.hasPriorNoise());
+        mcts.expand(&root);
+        ASSERT_TRUE(root.hasPriorNoise());
+        const auto noise = root.getPriorNoise();
+        float sum = 0.0f;
+        for (float variate : noise)
+        {
+            EXPECT_GT(variate, 0.0f);
+            sum += variate;
+        }
+        EXPECT_NEAR(sum, 1.0f, 1e-5);
+
+        for (int i = 0; i < 100; ++i)
+        {
+            mcts.expand(&root);
+        }
+        EXPECT_EQ(root.getPriorNoise(), noise);
+
+        // The same statistics and noise select the same child.
+        EXPECT_EQ(pucb_strategy(root), pucb_strategy(root));
+    }
+
+    TEST(TranspositionTableTest, FindsLiveNodesAtTheSameDepth)
+    {
+        TranspositionTable table;
+        auto node = std::make_shared<TreeNode>(std::make_unique<GameState>(), GameState::NUM_MOVES);
+        table.insert(node, 3);
+
+        EXPECT_EQ(table.find(GameState(), 3), node);
+        EXPECT_EQ(table.find(GameState(), 2), nullptr);
+        EXPECT_EQ(table.find(*GameState().move(0), 3), nullptr);
+        EXPECT_EQ(table.getLookups(), 3u);
+        EXPECT_EQ(table.getHits(), 1u);
+
+        // Entries don't keep their nodes alive.
+        node.reset();
+        EXPECT_EQ(table.find(GameState(), 3), nullptr);
+        EXPECT_EQ(table.size(), 0u);
+    }
+
+    TEST(TranspositionTableTest, ParentsShareTransposedChild)
+    {
+        GameState root;
+        // After these positions, moves 2 and 0 respectively reach the same position.
+        TreeNode first(root.move(0)->move(0)->move(0)->move(0), GameState::NUM_MOVES);
+        TreeNode second(root.move(0)->move(0)->move(2)->move(0), GameState::NUM_MOVES);
+
+        TranspositionTable table;
+        ZeroValueUniformEvaluator evaluator(GameState::NUM_MOVES);
+        ASSERT_TRUE(first.initChildren(evaluator, &table, 4).has_value());
+        first.getChildStates()[2]->update(Player::ONE, AverageValue(1.0f, 1));
+
+        std::vector<TreeNode *> evaluated;
+        Evaluator recording = [&](const std::vector<TreeNode *> &nodes)
+        {
+            evaluated = nodes;
+            evaluator(nodes);
+        };
+        ASSERT_TRUE(second.initChildren(recording, &table, 4).has_value());
+
+        EXPECT_EQ(second.getChildStates()[0], first.getChildStates()[2]);
+        EXPECT_EQ(table.getHits(), 1u);
+        // The shared child is not evaluated again and keeps its statistics.
+        EXPECT_EQ(evaluated[0], nullptr);
+        EXPECT_EQ(second.getChildStates()[0]->getVisits(), 1);
+
+        std::vector<TreeNode *> fresh;
+        second.appendNewChildren(fresh);
+        EXPECT_EQ(std::count(fresh.begin(), fresh.end(), second.getChildStates()[0].get()), 0);
+    }
+
+    TEST(MonteCarloTreeSearchTest, TranspositionTableSavesEvaluations)
+    {
+        auto root_state = std::make_unique<GameState>();
+        root_state = root_state->move(0)->move(0);
+
+        auto search = [&](TranspositionTable *table)
+        {
+            ZeroValueUniformEvaluator uniform(GameState::NUM_MOVES);
+            int rows = 0;
+            Evaluator counting = [&](const std::vector<TreeNode *> &nodes)
+            {
+                rows += std::count_if(nodes.begin(), nodes.end(), [](TreeNode *node)
+                                      { return node != nullptr; });
+                uniform(nodes);
+            };
+            PredictiveUpperConfidenceBound pucb_strategy(1);
+            MonteCarloTreeSearch mcts(std::ref(pucb_strategy), counting);
+            mcts.setTranspositionTable(table);
+
+            TreeNode root(std::make_unique<GameState>(*root_state), GameState::NUM_MOVES);
+            for (int i = 0; i < 3000; ++i)
+            {
+                mcts.expand(&root);
+            }
+            EXPECT_EQ(root.getVisits(), 3000);
+            return rows;
+        };
+
+        TranspositionTable table;
+        const int rows_with_table = search(&table);
+        const int rows_without_table = search(nullptr);
+
+        EXPECT_GT(table.getHits(), 0u);
+        EXPECT_LT(rows_with_table, rows_without_table);
+    }
+
+    TEST(MonteCarloTreeSearchTest, BestMoveRanksProvenDrawsByTheirValueOfZero)
+    {
+        TreeNode root(std::make_unique<GameState>(), GameState::NUM_MOVES);
+        ASSERT_TRUE(root.createChildren());
+        const auto &children = root.getChildStates();
+        ASSERT_EQ(root.state().getCurrentPlayer(), Player::ONE);
+
+        // A heavily visited proven loss, a proven draw, and two unproven moves, the most
+        // visited of which is losing for the player to move.
+        children[0]->setProvenWinner(Player::TWO);
+        children[1]->setProvenWinner(Player::NONE);
+        for (int i = 0; i < 50; ++i)
+        {
+            children[0]->update(Player::TWO, AverageValue(-1.0f, 1));
+        }
+        for (int i = 0; i < 3; ++i)
+        {
+            children[2]->update(Player::NONE, AverageValue(-0.5f, 1));
+        }
+        children[3]->update(Player::NONE, AverageValue(0.5f, 1));
+        EXPECT_EQ(root.getBestMove(), 1);
+        std::vector<MoveAnalysis> lines = analyzeRoot(root, GameState::NUM_MOVES);
+        ASSERT_EQ(lines.size(), static_cast<size_t>(GameState::NUM_MOVES));
+        EXPECT_EQ(lines[0].move, 1);
+        EXPECT_EQ(lines[1].move, 2);
+        EXPECT_EQ(lines[2].move, 3);
+        EXPECT_EQ(lines.back().move, 0);
+
+        // Once the most visited unproven move is worth more than the draw, it is played.
+        for (int i = 0; i < 3; ++i)
+        {
+            children[2]->update(Player::NONE, AverageValue(1.0f, 1));
+        }
+        ASSERT_GT(children[2]->getAverageValue().getValue(Player::ONE), 0.0f);
+        EXPECT_EQ(root.getBestMove(), 2);
+        lines = analyzeRoot(root, GameState::NUM_MOVES);
+        ASSERT_EQ(lines.size(), static_cast<size_t>(GameState::NUM_MOVES));
+        EXPECT_EQ(lines[0].move, 2);
+        // The draw now ranks below every unproven move, but still above the proven loss.
+        EXPECT_EQ(lines[GameState::NUM_MOVES - 2].move, 1);
+        EXPECT_EQ(lines.back().move, 0);
+
+        // A proven win beats them all, however few its visits.
+        children[4]->setProvenWinner(Player::ONE);
+        EXPECT_EQ(root.getBestMove(), 4);
+    }
+
+    TEST(MonteCarloTreeSearchTest, AnalyzeRootReportsTheBestLines)
+    {
+        auto root_state = std::make_unique<GameState>();
+        root_state = root_state->move(8)->move(1)->move(7)->move(3);
+        PredictiveUpperConfidenceBound pucb_strategy(1);
+        MonteCarloTreeSearch mcts(std::ref(pucb_strategy), ZeroValueUniformEvaluator(GameState::NUM_MOVES));
+        TreeNode root(std::move(root_state), GameState::NUM_MOVES);
+        for (int i = 0; i < 2000; ++i)
+        {
+            mcts.expand(&root);
+        }
+
+        const std::vector<MoveAnalysis> lines = analyzeRoot(root, 3);
+        ASSERT_EQ(lines.size(), 3u);
+        EXPECT_EQ(lines[0].move, root.getBestMove());
+        const Player mover = root.state().getCurrentPlayer();
+        for (size_t i = 0; i < lines.size(); ++i)
+        {
+            const TreeNode &child = *root.getChildStates()[lines[i].move];
+            EXPECT_EQ(lines[i].visits, child.getVisits());
+            EXPECT_EQ(lines[i].value, child.getAverageValue().getValue(mover));
+            EXPECT_EQ(lines[i].prior, root.evaluation().getPolicy()[lines[i].move]);
+            if (i > 0)
+            {
+                EXPECT_GE(lines[i - 1].visits, lines[i].visits);
+            }
+
+            // The variation follows the best reply of every node below the move.
+            const std::vector<int> &variation = lines[i].principalVariation;
+            ASSERT_GE(variation.size(), 2u);
+            EXPECT_EQ(variation[0], lines[i].move);
+            const TreeNode *node = &child;
+            for (size_t ply = 1; ply < variation.size(); ++ply)
+            {
+                EXPECT_EQ(variation[ply], node->getBestMove());
+                node = node->getChildStates()[variation[ply]].get();
+            }
+            EXPECT_EQ(node->getBestMove(), -1);
+        }
+
+        // Asking for more lines than there are moves returns every move.
+        int moves = 0;
+        for (const auto &child : root.getChildStates())
+        {
+            moves += child != nullptr ? 1 : 0;
+        }
+        EXPECT_EQ(analyzeRoot(root, GameState::NUM_MOVES).size(), static_cast<size_t>(moves));
+    }
+
+    TEST(MonteCarloTreeSearchTest, AnalyzeRootRanksProvenWinsFirst)
+    {
+        auto root_state = std::make_unique<GameState>();
+        root_state = root_state->move(8)->move(1)->move(7)->move(3)->move(6)->move(3)->move(4)->move(1)->move(8)->move(8);
+        PredictiveUpperConfidenceBound pucb_strategy(1);
+        MonteCarloTreeSearch mcts(std::ref(pucb_strategy), ZeroValueUniformEvaluator(GameState::NUM_MOVES));
+        TreeNode root(std::move(root_state), GameState::NUM_MOVES);
+        for (int i = 0; i < 100; ++i)
+        {
+            mcts.expand(&root);
+        }
+
+        const std::vector<MoveAnalysis> lines = analyzeRoot(root, 1);
+        ASSERT_EQ(lines.size(), 1u);
+        EXPECT_EQ(lines[0].move, 8);
+        EXPECT_EQ(lines[0].provenWinner, root.state().getCurrentPlayer());
+        EXPECT_EQ(lines[0].principalVariation, std::vector<int>{8});
+    }
 } // namespace scout
\ No newline at end of file
@@ -0,0 +1,297 @@
+#include "lib/mcts.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <new>
+
+#include "gtest/gtest.h"
+
+// Counts every allocation of this test binary through the replaceable global operator new.
+// Every form of new and delete, plain, array, aligned and nothrow, goes through the two
+// helpers below, so that allocation and release always match.
+namespace
+{
+    std::atomic<long> allocations{0};
+
+    void *countedAllocation(std::size_t size, std::size_t alignment, bool nothrow = false)
+    {
+        ++allocations;
+        size = size == 0 ? 1 : size;
+        void *memory = alignment <= alignof(std::max_align_t)
+                           ? std::malloc(size)
+                           : std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+        if (memory == nullptr && !nothrow)
+        {
+            throw std::bad_alloc();
+        }
+        return memory;
+    }
+
+    // Not inlined: g++ would otherwise see free() called on memory from operator new and
+    // warn with -Wmismatched-new-delete, although both ends are the helpers above.
+    [[gnu::noinline]] void countedRelease(void *memory) noexcept { std::free(memory); }
+}
+
+void *operator new(std::size_t size) { return countedAllocation(size, alignof(std::max_align_t)); }
+void *operator new[](std::size_t size) { return countedAllocation(size, alignof(std::max_align_t)); }
+void *operator new(std::size_t size, std::align_val_t alignment)
+{
+    return countedAllocation(size, static_cast<std::size_t>(alignment));
+}
+void *operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return countedAllocation(size, static_cast<std::size_t>(alignment));
+}
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    return countedAllocation(size, alignof(std::max_align_t), true);
+}
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    return countedAllocation(size, alignof(std::max_align_t), true);
+}
+void *operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    return countedAllocation(size, static_cast<std::size_t>(alignment), true);
+}
+void *operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    return countedAllocation(size, static_cast<std::size_t>(alignment), true);
+}
+void operator delete(void *memory) noexcept { countedRelease(memory); }
+void operator delete[](void *memory) noexcept { countedRelease(memory); }
+void operator delete(void *memory, std::size_t) noexcept { countedRelease(memory); }
+void operator delete[](void *memory, std::size_t) noexcept { countedRelease(memory); }
+void operator delete(void *memory, std::align_val_t) noexcept { countedRelease(memory); }
+void operator delete[](void *memory, std::align_val_t) noexcept { countedRelease(memory); }
+void operator delete(void *memory, std::size_t, std::align_val_t) noexcept { countedRelease(memory); }
+void operator delete[](void *memory, std::size_t, std::align_val_t) noexcept { countedRelease(memory); }
+void operator delete(void *memory, const std::nothrow_t &) noexcept { countedRelease(memory); }
+void operator delete[](void *memory, const std::nothrow_t &) noexcept { countedRelease(memory); }
+void operator delete(void *memory, std::align_val_t, const std::nothrow_t &) noexcept { countedRelease(memory); }
+void operator delete[](void *memory, std::align_val_t, const std::nothrow_t &) noexcept { countedRelease(memory); }
+
+namespace scout
+{
+
+    namespace
+    {
+        std::unique_ptr<GameState> middlegamePosition()
+        {
+            auto state = std::make_unique<GameState>();
+            return state->move(8)->move(1)->move(7)->move(3);
+        }
+    }
+
+    TEST(NodePoolTest, ReleasedNodesAreReused)
+    {
+        NodePool pool;
+        {
+            std::shared_ptr<TreeNode> root = pool.acquire(*middlegamePosition());
+            root->createChildren(nullptr, 0, &pool);
+            ZeroValueUniformEvaluator(GameState::NUM_MOVES)({root->getChildStates()[0].get()});
+            EXPECT_EQ(pool.getFreeNodes(), 0u);
+        }
+        const size_t created = pool.getCreatedNodes();
+        EXPECT_GT(created, 1u);
+        // The root released its children along with itself.
+        EXPECT_EQ(pool.getFreeNodes(), created);
+
+        std::shared_ptr<TreeNode> root = pool.acquire(GameState());
+        EXPECT_EQ(pool.getCreatedNodes(), created);
+        // A reused node starts out like a new one.
+        EXPECT_FALSE(root->isInitialized());
+        EXPECT_EQ(root->getVisits(), 0);
+        EXPECT_EQ(root->state(), GameState());
+        for (float prior : root->evaluation().getPolicy())
+        {
+            EXPECT_EQ(prior, 0.0f);
+        }
+        for (const auto &child : root->getChildStates())
+        {
+            EXPECT_EQ(child, nullptr);
+        }
+    }
+
+    TEST(NodePoolTest, SteadyStateExpandDoesNotAllocate)
+    {
+        const GameState position = *middlegamePosition();
+        PredictiveUpperConfidenceBound pucb_strategy(1);
+        MonteCarloTreeSearch mcts(std::ref(pucb_strategy), ZeroValueUniformEvaluator(GameState::NUM_MOVES));
+
+        // Without a pool, every expansion allocates its children.
+        {
+            TreeNode root(std::make_unique<GameState>(position), GameState::NUM_MOVES);
+            mcts.expand(&root);
+            const long before = allocations;
+            mcts.expand(&root);
+            EXPECT_GT(allocations - before, 0);
+        }
+
+        NodePool pool;
+        mcts.setNodePool(&pool);
+        auto search = [&]
+        {
+            // The same seed grows the same tree, which the released nodes then fit exactly.
+            pucb_strategy = PredictiveUpperConfidenceBound(1);
+            std::shared_ptr<TreeNode> root = pool.acquire(position);
+            const long before = allocations;
+            for (int i = 0; i < 2000; ++i)
+            {
+                mcts.expand(root.get());
+            }
+            return allocations - before;
+        };
+
+        EXPECT_GT(search(), 0);
+        const size_t created = pool.getCreatedNodes();
+        EXPECT_EQ(search(), 0);
+        EXPECT_EQ(pool.getCreatedNodes(), created);
+    }
+
+    TEST(NodePoolTest, ByteBudgetCapsTheTree)
+    {
+        NodePool pool;
+        const size_t budget = 3000 * NodePool::bytesPerNode();
+        pool.setByteBudget(budget);
+        PredictiveUpperConfidenceBound pucb_strategy(1);
+        MonteCarloTreeSearch mcts(std::ref(pucb_strategy), ZeroValueUniformEvaluator(GameState::NUM_MOVES));
+        mcts.setNodePool(&pool);
+
+        TreeNode root(middlegamePosition(), GameState::NUM_MOVES);
+        size_t peak = 0;
+        for (int i = 0; i < 5000; ++i)
+        {
+            mcts.expand(&root);
+            peak = std::max(peak, pool.getBytesInUse());
+        }
+
+        // One expansion past the budget at most.
+        EXPECT_LE(peak, budget + GameState::NUM_MOVES * NodePool::bytesPerNode());
+        EXPECT_GT(pool.getPrunings(), 0u);
+        EXPECT_GT(pool.getPrunedNodes(), 0u);
+        // Pruned nodes were reused instead of new ones being created.
+        EXPECT_LE(pool.getCreatedNodes(), budget / NodePool::bytesPerNode() + GameState::NUM_MOVES);
+
+        // The root statistics still count every simulation.
+        EXPECT_EQ(root.getVisits(), 5000);
+        int child_visits = 0;
+        for (const auto &child : root.getChildStates())
+        {
+            if (child != nullptr)
+            {
+                child_visits += child->getVisits();
+            }
+        }
+        EXPECT_EQ(child_visits, root.getVisits() - 1);
+    }
+
+    TEST(NodePoolTest, ByteBudgetCapsATreeWithTranspositions)
+    {
+        NodePool pool;
+        const size_t budget = 1000 * NodePool::bytesPerNode();
+        const size_t expansion = GameState::NUM_MOVES * NodePool::bytesPerNode();
+        pool.setByteBudget(budget);
+        TranspositionTable transpositions;
+        PredictiveUpperConfidenceBound pucb_strategy(1);
+        MonteCarloTreeSearch mcts(std::ref(pucb_strategy), ZeroValueUniformEvaluator(GameState::NUM_MOVES));
+        mcts.setNodePool(&pool);
+        mcts.setTranspositionTable(&transpositions);
+
+        TreeNode root(middlegamePosition(), GameState::NUM_MOVES);
+        int short_prunings = 0;
+        for (int i = 0; i < 20000; ++i)
+        {
+            const std::uint64_t prunings = pool.getPrunings();
+            mcts.expand(&root);
+            // Shared nodes gather visits from several parents and survive the pruning of
+            // one of them, yet every pruning still reaches three quarters of the budget.
+            if (pool.getPrunings() > prunings && pool.getBytesInUse() > budget / 4 * 3 + expansion)
+            {
+                ++short_prunings;
+            }
+        }
+
+        EXPECT_GT(transpositions.getHits(), 0u);
+        EXPECT_GT(pool.getPrunings(), 0u);
+        EXPECT_EQ(short_prunings, 0);
+        EXPECT_EQ(root.getVisits(), 20000);
+    }
+
+    TEST(NodePoolTest, TranspositionTableMayOutliveThePool)
+    {
+        // The table's entries hold control blocks from the pool's resource. Releasing them
+        // after the pool is gone is only safe because the resource outlives the pool; run
+        // under AddressSanitizer (--config=asan) to catch a use after free here.
+        auto transpositions = std::make_unique<TranspositionTable>();
+        {
+            NodePool pool;
+            PredictiveUpperConfidenceBound pucb_strategy(1);
+            MonteCarloTreeSearch mcts(std::ref(pucb_strategy), ZeroValueUniformEvaluator(GameState::NUM_MOVES));
+            mcts.setNodePool(&pool);
+            mcts.setTranspositionTable(transpositions.get());
+
+            std::shared_ptr<TreeNode> root = pool.acquire(*middlegamePosition());
+            for (int i = 0; i < 200; ++i)
+            {
+                mcts.expand(root.get());
+            }
+            ASSERT_GT(transpositions->size(), 0u);
+        }
+
+        // Every entry has expired with its node, and the blocks go back to the resource.
+        const auto position = middlegamePosition();
+        for (int move = 0; move < GameState::NUM_MOVES; ++move)
+        {
+            if (position->isMoveAllowed(move))
+            {
+                EXPECT_EQ(transpositions->find(*position->move(move), 1), nullptr);
+            }
+        }
+        transpositions->clear();
+        EXPECT_EQ(transpositions->size(), 0u);
+
+        // Destroying the table after another pool is gone works the same way.
+        {
+            NodePool pool;
+            std::shared_ptr<TreeNode> node = pool.acquire(GameState());
+            transpositions->insert(node, 0);
+        }
+        transpositions.reset();
+    }
+
+    TEST(NodePoolTest, PruningKeepsTheMostVisitedPath)
+    {
+        NodePool pool;
+        PredictiveUpperConfidenceBound pucb_strategy(1);
+        MonteCarloTreeSearch mcts(std::ref(pucb_strategy), ZeroValueUniformEvaluator(GameState::NUM_MOVES));
+        mcts.setNodePool(&pool);
+
+        TreeNode root(middlegamePosition(), GameState::NUM_MOVES);
+        for (int i = 0; i < 2000; ++i)
+        {
+            mcts.expand(&root);
+        }
+        const int best_move = root.getBestMove();
+        const std::vector<float> statistics = root.encode();
+        const size_t live = pool.getLiveNodes();
+
+        pool.setByteBudget(live / 2 * NodePool::bytesPerNode());
+        const size_t pruned = pool.prune(root);
+
+        EXPECT_GT(pruned, 0u);
+        EXPECT_EQ(pool.getLiveNodes(), live - pruned);
+        EXPECT_LE(pool.getBytesInUse(), live / 2 * NodePool::bytesPerNode());
+        EXPECT_EQ(pool.getPrunings(), 1u);
+        EXPECT_EQ(root.encode(), statistics);
+        EXPECT_EQ(root.getBestMove(), best_move);
+        EXPECT_TRUE(root.getChildStates()[best_move]->isInitialized());
+
+        // Under budget, nothing is pruned.
+        EXPECT_EQ(pool.prune(root), 0u);
+        EXPECT_EQ(pool.getPrunings(), 1u);
+    }
+
+} // namespace scout
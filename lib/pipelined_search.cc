@@ -0,0 +1,81 @@
+#include "lib/pipelined_search.h"
+
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <utility>
+
+namespace scout
+{
+
+    PipelinedSearch::PipelinedSearch(ExpansionStrategy strategy, Evaluator evaluator, int batchSize)
+        // A batch is submitted whole, so the server needn't wait for more rows.
+        : server_(std::move(evaluator), batchSize * GameState::NUM_MOVES, std::chrono::microseconds(0)),
+          mcts_(std::move(strategy), server_.evaluator()),
+          batch_size_(batchSize)
+    {
+        if (batchSize <= 0)
+        {
+            throw std::invalid_argument("The batch size must be positive.");
+        }
+    }
+
+    int PipelinedSearch::search(TreeNode &root, int simulations)
+    {
+        using Clock = std::chrono::steady_clock;
+        const Clock::time_point start = Clock::now();
+        mcts_.resetStats();
+        Clock::duration waited{0};
+
+        int done = 0;
+        LeafBatch *in_flight = &batches_[0];
+        LeafBatch *collecting = &batches_[1];
+        std::future<void> evaluated;
+        auto submit = [&](LeafBatch &batch)
+        {
+            evaluated = batch.rows.empty() ? std::future<void>() : server_.submit(batch.rows);
+        };
+
+        while (true)
+        {
+            if (in_flight->leaves == 0)
+            {
+                // Nothing in flight: at the start, or after a batch of proven leaves only.
+                if (done >= simulations || root.isProven())
+                {
+                    break;
+                }
+                done += mcts_.collectBatch(&root, batch_size_, *in_flight);
+                submit(*in_flight);
+                continue;
+            }
+
+            // Select the next batch while the current one is evaluated, unless the
+            // simulations in flight already complete the search.
+            const bool more = done + in_flight->leaves < simulations;
+            if (more)
+            {
+                done += mcts_.collectBatch(&root, batch_size_, *collecting);
+            }
+
+            const Clock::time_point wait_start = Clock::now();
+            if (evaluated.valid())
+            {
+                evaluated.get();
+            }
+            waited += Clock::now() - wait_start;
+            done += mcts_.backUpBatch(*in_flight);
+
+            std::swap(in_flight, collecting);
+            submit(*in_flight);
+        }
+
+        last_stats_ = mcts_.getStats();
+        last_stats_.evaluationTime = waited;
+        last_stats_.nodes = countNodes(root);
+        last_stats_.bytes = countBytes(root);
+        last_stats_.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start);
+        return done;
+    }
+
+} // namespace scout
@@ -0,0 +1,59 @@
+#ifndef WASM_SCOUT_LIB_PIPELINED_SEARCH_H
+#define WASM_SCOUT_LIB_PIPELINED_SEARCH_H
+
+#include <array>
+
+#include "lib/inference_server.h"
+#include "lib/mcts.h"
+
+namespace scout
+{
+
+    /**
+     * @brief A batched search that overlaps tree work with evaluation.
+     *
+     * Batches are evaluated by an InferenceServer on its own thread. While batch N is
+     * being evaluated, this thread selects and expands batch N+1 with virtual loss; then
+     * it waits for batch N, backs it up and submits batch N+1. The evaluator and the tree
+     * each stay busy while the other works, instead of taking turns as in expandBatch().
+     *
+     * Selection stops at the leaves of the batch in flight, so it never reads their
+     * children while they are being written. For the same reason the search uses
+     * neither a transposition table nor a NodePool budget, which could share or release
+     * those children.
+     */
+    class PipelinedSearch
+    {
+    public:
+        /**
+         * @param evaluator Runs on the server thread, one batch at a time.
+         * @param batchSize Leaves selected per batch (about 9 rows each).
+         */
+        PipelinedSearch(ExpansionStrategy strategy, Evaluator evaluator, int batchSize);
+
+        /**
+         * @brief Runs at least `simulations` simulations on `root`, or until it is proven,
+         * and returns how many ran. Every batch is backed up before it returns. If the
+         * evaluator throws, the exception reaches the caller and the tree, with a batch
+         * still holding virtual loss, should be discarded.
+         */
+        int search(TreeNode &root, int simulations);
+
+        /**
+         * @brief The counters of the last search(). Evaluation time is the time this
+         * thread waited for a batch, which is all the overlap didn't hide.
+         */
+        const SearchStats &getLastStats() const { return last_stats_; }
+
+    private:
+        InferenceServer server_;
+        MonteCarloTreeSearch mcts_;
+        const int batch_size_;
+        // The batch in flight and the one being collected.
+        std::array<LeafBatch, 2> batches_;
+        SearchStats last_stats_;
+    };
+
+} // namespace scout
+
+#endif // WASM_SCOUT_LIB_PIPELINED_SEARCH_H
@@ -0,0 +1,77 @@
+#include "lib/pipelined_search.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+namespace scout
+{
+
+    namespace
+    {
+        // Checks that every node's virtual loss and evaluation are settled.
+        void expectSettled(const TreeNode &node)
+        {
+            EXPECT_EQ(node.getVirtualLoss(), 0);
+            EXPECT_FALSE(node.isAwaitingEvaluation());
+            for (const auto &child : node.getChildStates())
+            {
+                if (child != nullptr)
+                {
+                    expectSettled(*child);
+                }
+            }
+        }
+    }
+
+    TEST(PipelinedSearchTest, RunsTheRequestedSimulations)
+    {
+        const std::thread::id search_thread = std::this_thread::get_id();
+        std::atomic<int> calls{0};
+        std::atomic<bool> on_search_thread{false};
+        ZeroValueUniformEvaluator uniform(GameState::NUM_MOVES);
+        Evaluator evaluator = [&](const std::vector<TreeNode *> &nodes)
+        {
+            ++calls;
+            on_search_thread = on_search_thread || std::this_thread::get_id() == search_thread;
+            uniform(nodes);
+        };
+        PredictiveUpperConfidenceBound pucb_strategy(1);
+        PipelinedSearch search(std::ref(pucb_strategy), evaluator, 8);
+
+        auto root_state = std::make_unique<GameState>();
+        TreeNode root(root_state->move(8)->move(1)->move(7)->move(3), GameState::NUM_MOVES);
+        const int simulations = search.search(root, 1000);
+
+        EXPECT_GE(simulations, 1000);
+        EXPECT_LT(simulations, 1000 + 8);
+        EXPECT_EQ(root.getVisits(), simulations);
+        EXPECT_EQ(search.getLastStats().simulations, static_cast<std::uint64_t>(simulations));
+        EXPECT_EQ(search.getLastStats().evaluatorCalls, static_cast<std::uint64_t>(calls.load()));
+        EXPECT_FALSE(on_search_thread);
+        expectSettled(root);
+
+        // The tree can be searched further.
+        EXPECT_GE(search.search(root, 100), 100);
+        EXPECT_EQ(root.getVisits(), simulations + static_cast<int>(search.getLastStats().simulations));
+    }
+
+    TEST(PipelinedSearchTest, FindsTheWinningMove)
+    {
+        auto root_state = std::make_unique<GameState>();
+        root_state = root_state->move(8)->move(1)->move(7)->move(3)->move(6)->move(3)->move(4)->move(1)->move(8)->move(8);
+        PredictiveUpperConfidenceBound pucb_strategy(1);
+        PipelinedSearch search(std::ref(pucb_strategy), ZeroValueUniformEvaluator(GameState::NUM_MOVES), 4);
+        TreeNode root(std::move(root_state), GameState::NUM_MOVES);
+
+        // The search stops early once the win is proven.
+        EXPECT_LT(search.search(root, 5000), 5000);
+        EXPECT_TRUE(root.isProven());
+        EXPECT_EQ(root.getBestMove(), 8);
+        expectSettled(root);
+    }
+
+} // namespace scout
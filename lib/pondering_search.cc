@@ -0,0 +1,89 @@
+#include "lib/pondering_search.h"
+
+#include <utility>
+#include <vector>
+
+namespace scout
+{
+
+    PonderingSearch::PonderingSearch(ExpansionStrategy strategy, Evaluator evaluator)
+        : search_(std::move(strategy), std::move(evaluator))
+    {
+        search_.setNodePool(&pool_);
+    }
+
+    SearchResult PonderingSearch::search(const GameState &state, const SearchLimits &limits)
+    {
+        reroot(state);
+        reused_visits_ = root_->getVisits();
+        return search_.search(*root_, limits);
+    }
+
+    void PonderingSearch::cancel()
+    {
+        search_.cancel();
+    }
+
+    void PonderingSearch::clear()
+    {
+        root_.reset();
+        reused_visits_ = 0;
+    }
+
+    void PonderingSearch::setByteBudget(size_t bytes)
+    {
+        pool_.setByteBudget(bytes);
+    }
+
+    void PonderingSearch::reroot(const GameState &state)
+    {
+        if (root_ != nullptr && root_->state() == state)
+        {
+            return;
+        }
+
+        // Breadth first, so the shallowest node for the position wins.
+        std::shared_ptr<TreeNode> found;
+        std::vector<std::shared_ptr<TreeNode>> level;
+        if (root_ != nullptr)
+        {
+            level.push_back(root_);
+        }
+        for (int depth = 1; depth <= MAX_REROOT_DEPTH && found == nullptr && !level.empty(); ++depth)
+        {
+            std::vector<std::shared_ptr<TreeNode>> next;
+            for (const auto &node : level)
+            {
+                for (const auto &child : node->getChildStates())
+                {
+                    if (child == nullptr)
+                    {
+                        continue;
+                    }
+                    if (child->state() == state)
+                    {
+                        found = child;
+                        break;
+                    }
+                    next.push_back(child);
+                }
+                if (found != nullptr)
+                {
+                    break;
+                }
+            }
+            level = std::move(next);
+        }
+        level.clear();
+
+        // A leaf proven outside the tree, e.g. by an EndgameSolver, has no moves to choose
+        // from; searching it again as a new root expands it.
+        if (found != nullptr && found->isProven() && !found->isInitialized())
+        {
+            found.reset();
+        }
+        // Holding `found` keeps the subtree alive while the old root releases the rest.
+        root_ = found != nullptr ? std::move(found) : pool_.acquire(state);
+    }
+
+} // namespace scout
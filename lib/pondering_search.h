@@ -0,0 +1,62 @@
+#ifndef WASM_SCOUT_LIB_PONDERING_SEARCH_H
+#define WASM_SCOUT_LIB_PONDERING_SEARCH_H
+
+#include <cstddef>
+#include <memory>
+
+#include "lib/anytime_search.h"
+#include "lib/game.h"
+#include "lib/mcts.h"
+
+namespace scout
+{
+
+    /**
+     * @brief An AnytimeSearch that keeps its tree between searches, so the engine can go
+     * on searching while the opponent thinks.
+     *
+     * Each search() re-roots the kept tree into the searched position if the tree already
+     * contains it within MAX_REROOT_DEPTH moves of its root, and continues from there; the
+     * rest of the tree is released. Pondering is a series of short searches of the
+     * position the opponent has to move in; when the opponent's move arrives, the next
+     * search starts from the subtree the pondering has already grown for it.
+     */
+    class PonderingSearch
+    {
+    public:
+        // Far enough for the opponent's reply, and for the engine's own reply to that.
+        static constexpr int MAX_REROOT_DEPTH = 2;
+
+        PonderingSearch(ExpansionStrategy strategy, Evaluator evaluator);
+
+        // Searches `state`, continuing the kept tree if it contains the position.
+        SearchResult search(const GameState &state, const SearchLimits &limits);
+
+        // Asks the running search to stop; see AnytimeSearch::cancel().
+        void cancel();
+
+        // Releases the kept tree.
+        void clear();
+
+        // Caps the memory of the kept tree; see NodePool::setByteBudget().
+        void setByteBudget(size_t bytes);
+
+        // The root of the kept tree, or nullptr before the first search.
+        const TreeNode *getRoot() const { return root_.get(); }
+
+        // The visits the last search() found at its root from earlier searches.
+        int getReusedVisits() const { return reused_visits_; }
+
+    private:
+        // Makes root_ the node for `state`: the kept root, one of its descendants, or a new node.
+        void reroot(const GameState &state);
+
+        NodePool pool_;
+        AnytimeSearch search_;
+        std::shared_ptr<TreeNode> root_;
+        int reused_visits_ = 0;
+    };
+
+} // namespace scout
+
+#endif // WASM_SCOUT_LIB_PONDERING_SEARCH_H
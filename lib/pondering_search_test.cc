@@ -0,0 +1,94 @@
+#include "lib/pondering_search.h"
+
+#include <functional>
+#include <memory>
+
+#include "gtest/gtest.h"
+
+namespace scout
+{
+
+    namespace
+    {
+        std::unique_ptr<GameState> middlegamePosition()
+        {
+            auto state = std::make_unique<GameState>();
+            return state->move(8)->move(1)->move(7)->move(3);
+        }
+
+        SearchLimits simulations(int count)
+        {
+            SearchLimits limits;
+            limits.maxSimulations = count;
+            return limits;
+        }
+    }
+
+    TEST(PonderingSearchTest, ContinuesInTheSubtreeOfThePlayedMove)
+    {
+        PredictiveUpperConfidenceBound pucb_strategy(1);
+        PonderingSearch search(std::ref(pucb_strategy), ZeroValueUniformEvaluator(GameState::NUM_MOVES));
+        const GameState position = *middlegamePosition();
+
+        SearchResult result = search.search(position, simulations(2000));
+        EXPECT_EQ(search.getReusedVisits(), 0);
+        const int played_visits = search.getRoot()->getChildStates()[result.bestMove]->getVisits();
+        ASSERT_GT(played_visits, 0);
+
+        const GameState next = position.afterMove(result.bestMove);
+        search.search(next, simulations(100));
+        EXPECT_EQ(search.getReusedVisits(), played_visits);
+        EXPECT_EQ(search.getRoot()->state(), next);
+        EXPECT_EQ(search.getRoot()->getVisits(), played_visits + 100);
+    }
+
+    TEST(PonderingSearchTest, PonderingGrowsTheTreeOfTheOpponentsReply)
+    {
+        PredictiveUpperConfidenceBound pucb_strategy(1);
+        PonderingSearch search(std::ref(pucb_strategy), ZeroValueUniformEvaluator(GameState::NUM_MOVES));
+        const GameState position = *middlegamePosition();
+        const GameState pondered = position.afterMove(search.search(position, simulations(200)).bestMove);
+
+        // Short slices, as the browser runs them between events.
+        for (int slice = 0; slice < 20; ++slice)
+        {
+            search.search(pondered, simulations(100));
+        }
+        const TreeNode &root = *search.getRoot();
+        int reply = -1;
+        for (int move = 0; move < GameState::NUM_MOVES; ++move)
+        {
+            if (root.getChildStates()[move] != nullptr && pondered.isMoveAllowed(move))
+            {
+                reply = move;
+                break;
+            }
+        }
+        ASSERT_NE(reply, -1);
+        const int pondered_visits = root.getChildStates()[reply]->getVisits();
+
+        const GameState next = pondered.afterMove(reply);
+        if (next.isGameOver())
+        {
+            GTEST_SKIP() << "The reply ends the game.";
+        }
+        search.search(next, simulations(1));
+        EXPECT_EQ(search.getReusedVisits(), pondered_visits);
+        EXPECT_GT(search.getReusedVisits(), 0);
+    }
+
+    TEST(PonderingSearchTest, UnrelatedPositionStartsANewTree)
+    {
+        PredictiveUpperConfidenceBound pucb_strategy(1);
+        PonderingSearch search(std::ref(pucb_strategy), ZeroValueUniformEvaluator(GameState::NUM_MOVES));
+        search.search(*middlegamePosition(), simulations(500));
+
+        search.search(GameState(), simulations(10));
+        EXPECT_EQ(search.getReusedVisits(), 0);
+        EXPECT_EQ(search.getRoot()->getVisits(), 10);
+
+        search.clear();
+        EXPECT_EQ(search.getRoot(), nullptr);
+    }
+
+} // namespace scout
@@ -0,0 +1,70 @@
+#ifndef WASM_SCOUT_LIB_RANDOM_H
+#define WASM_SCOUT_LIB_RANDOM_H
+
+#include <cstdint>
+#include <limits>
+
+namespace scout
+{
+
+    /**
+     * @brief The xoshiro128+ generator: four words of state, a few shifts and adds per
+     * number, and no 64-bit multiplies, so it is also cheap in WebAssembly.
+     *
+     * Satisfies UniformRandomBitGenerator, so it works with the <random> distributions,
+     * but the search uses its own float helpers, which only need the upper 24 bits
+     * (the low bits of xoshiro128+ are its weakest).
+     */
+    class Xoshiro128
+    {
+    public:
+        using result_type = std::uint32_t;
+
+        // Expands `seed` into the four state words with splitmix64, as the authors recommend.
+        explicit Xoshiro128(std::uint64_t seed)
+        {
+            for (int i = 0; i < 4; i += 2)
+            {
+                const std::uint64_t word = splitMix64(seed);
+                state_[i] = static_cast<std::uint32_t>(word);
+                state_[i + 1] = static_cast<std::uint32_t>(word >> 32);
+            }
+        }
+
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+        result_type operator()()
+        {
+            const std::uint32_t result = state_[0] + state_[3];
+            const std::uint32_t t = state_[1] << 9;
+            state_[2] ^= state_[0];
+            state_[3] ^= state_[1];
+            state_[1] ^= state_[2];
+            state_[0] ^= state_[3];
+            state_[2] ^= t;
+            state_[3] = (state_[3] << 11) | (state_[3] >> 21);
+            return result;
+        }
+
+        // A uniform float in (0, 1]: never 0, so that its logarithm is finite.
+        float uniformPositive()
+        {
+            return static_cast<float>(((*this)() >> 8) + 1) * (1.0f / 16777216.0f);
+        }
+
+    private:
+        static std::uint64_t splitMix64(std::uint64_t &x)
+        {
+            std::uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            return z ^ (z >> 31);
+        }
+
+        std::uint32_t state_[4];
+    };
+
+} // namespace scout
+
+#endif // WASM_SCOUT_LIB_RANDOM_H
@@ -0,0 +1,260 @@
+#include "lib/search.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <exception>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace scout
+{
+
+    Evaluator makeOnnxEvaluator()
+    {
+        // std::function needs a copyable target, so the session is shared by the copies.
+        auto evaluator = std::make_shared<OnnxEvaluator>();
+        return [evaluator](const std::vector<TreeNode *> &nodes)
+        { (*evaluator)(nodes); };
+    }
+
+    namespace
+    {
+        // Merges encoded roots, each weighted by the visits of the root it came from.
+        std::vector<float> mergeEncodedRoots(const std::vector<std::vector<float>> &encodedRoots,
+                                             const std::vector<float> &rootVisits)
+        {
+            if (encodedRoots.empty())
+            {
+                throw std::invalid_argument("No roots to merge.");
+            }
+
+            std::vector<float> merged;
+            float totalVisits = 0.0f;
+            for (size_t root = 0; root < encodedRoots.size(); ++root)
+            {
+                const std::vector<float> &encoded = encodedRoots[root];
+                const float visits = rootVisits[root];
+                if (merged.empty())
+                {
+                    merged.resize(encoded.size(), 0.0f);
+                }
+                if (encoded.size() != merged.size())
+                {
+                    throw std::invalid_argument("Roots have different numbers of moves.");
+                }
+
+                // Undo the per-tree normalisation so every tree counts by its visits.
+                for (size_t i = 0; i < encoded.size(); ++i)
+                {
+                    merged[i] += encoded[i] * visits;
+                }
+                totalVisits += visits;
+            }
+
+            if (totalVisits == 0)
+            {
+                throw std::logic_error("Merged roots have no visits.");
+            }
+
+            float childVisits = 0.0f;
+            for (size_t move = 1; move < merged.size(); ++move)
+            {
+                childVisits += merged[move];
+            }
+
+            merged[0] /= totalVisits;
+            for (size_t move = 1; move < merged.size(); ++move)
+            {
+                merged[move] /= childVisits;
+            }
+
+            return merged;
+        }
+    }
+
+    std::vector<float> mergeRootStatistics(const std::vector<const TreeNode *> &roots)
+    {
+        std::vector<std::vector<float>> encoded;
+        std::vector<float> visits;
+        encoded.reserve(roots.size());
+        visits.reserve(roots.size());
+        for (const TreeNode *root : roots)
+        {
+            encoded.push_back(root->encode());
+            visits.push_back(static_cast<float>(root->getVisits()));
+        }
+        return mergeEncodedRoots(encoded, visits);
+    }
+
+    int selectMove(const std::vector<float> &encoded)
+    {
+        int best_move = -1;
+        float best_share = 0.0f;
+        for (size_t i = 1; i < encoded.size(); ++i)
+        {
+            if (encoded[i] > best_share)
+            {
+                best_move = static_cast<int>(i) - 1;
+                best_share = encoded[i];
+            }
+        }
+        return best_move;
+    }
+
+    bool pinCurrentThread(int cpu)
+    {
+#if defined(__linux__)
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(cpu, &cpus);
+        return pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+#else
+        (void)cpu;
+        return false;
+#endif
+    }
+
+    namespace
+    {
+        // Derives the seed of tree `index` so that neighbouring trees get unrelated streams.
+        std::uint32_t deriveSeed(std::uint32_t seed, int index)
+        {
+            std::seed_seq sequence{seed, static_cast<std::uint32_t>(index)};
+            std::array<std::uint32_t, 1> derived;
+            sequence.generate(derived.begin(), derived.end());
+            return derived[0];
+        }
+    }
+
+    RootParallelSearch::RootParallelSearch(int numTrees, const EvaluatorFactory &evaluatorFactory, std::uint32_t seed)
+    {
+        if (numTrees < 1)
+        {
+            throw std::invalid_argument("Root parallel search needs at least one tree.");
+        }
+
+        evaluators_.reserve(numTrees);
+        strategies_.reserve(numTrees);
+        pools_.reserve(numTrees);
+        for (int k = 0; k < numTrees; ++k)
+        {
+            evaluators_.push_back(evaluatorFactory());
+            strategies_.emplace_back(deriveSeed(seed, k));
+            // Empty until its tree's thread fills it.
+            pools_.push_back(std::make_unique<NodePool>());
+        }
+    }
+
+    void RootParallelSearch::reseed(std::uint32_t seed)
+    {
+        for (int k = 0; k < getNumTrees(); ++k)
+        {
+            strategies_[k].reseed(deriveSeed(seed, k));
+        }
+    }
+
+    RootParallelSearch::RootParallelSearch(int numTrees, const EvaluatorFactory &evaluatorFactory)
+        : RootParallelSearch(numTrees, evaluatorFactory, std::random_device{}())
+    {
+    }
+
+    std::vector<float> RootParallelSearch::search(const GameState &state, int expansionsPerTree)
+    {
+        if (expansionsPerTree < 1)
+        {
+            throw std::invalid_argument("Every tree needs at least one expansion.");
+        }
+        if (state.isGameOver())
+        {
+            throw std::invalid_argument("Cannot search a finished game.");
+        }
+
+        const int numTrees = getNumTrees();
+        // Every thread encodes its root and then releases its tree itself, into its pool.
+        std::vector<std::vector<float>> encoded_roots(numTrees);
+        std::vector<float> root_visits(numTrees);
+        std::vector<std::exception_ptr> errors(numTrees);
+        std::vector<SearchStats> stats(numTrees);
+        const auto start = std::chrono::steady_clock::now();
+
+        auto searchTree = [&](int k)
+        {
+            try
+            {
+                if (pin_threads_)
+                {
+                    const int cpus = std::max(1u, std::thread::hardware_concurrency());
+                    pinCurrentThread(k % cpus);
+                }
+                MonteCarloTreeSearch mcts(std::ref(strategies_[k]), std::ref(evaluators_[k]));
+                std::shared_ptr<TreeNode> root;
+                if (node_pools_)
+                {
+                    mcts.setNodePool(pools_[k].get());
+                    root = pools_[k]->acquire(state);
+                }
+                else
+                {
+                    root = std::make_shared<TreeNode>(std::make_unique<GameState>(state), GameState::NUM_MOVES);
+                }
+                for (int i = 0; i < expansionsPerTree && !root->isProven(); ++i)
+                {
+                    mcts.expand(root.get());
+                }
+                stats[k] = mcts.getStats();
+                stats[k].nodes = countNodes(*root);
+                stats[k].bytes = countBytes(*root);
+                encoded_roots[k] = root->encode();
+                root_visits[k] = static_cast<float>(root->getVisits());
+            }
+            catch (...)
+            {
+                errors[k] = std::current_exception();
+            }
+        };
+
+        // The calling thread searches the first tree itself, unless that would pin it.
+        const int first_worker = pin_threads_ ? 0 : 1;
+        std::vector<std::thread> workers;
+        workers.reserve(numTrees - first_worker);
+        for (int k = first_worker; k < numTrees; ++k)
+        {
+            workers.emplace_back(searchTree, k);
+        }
+        if (!pin_threads_)
+        {
+            searchTree(0);
+        }
+        for (auto &worker : workers)
+        {
+            worker.join();
+        }
+
+        for (const auto &error : errors)
+        {
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+        }
+
+        last_stats_ = SearchStats();
+        for (const SearchStats &tree_stats : stats)
+        {
+            last_stats_ += tree_stats;
+        }
+        last_stats_.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start);
+
+        return mergeEncodedRoots(encoded_roots, root_visits);
+    }
+
+} // namespace scout
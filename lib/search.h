@@ -0,0 +1,109 @@
+#ifndef WASM_SCOUT_LIB_SEARCH_H
+#define WASM_SCOUT_LIB_SEARCH_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "lib/game.h"
+#include "lib/mcts.h"
+
+namespace scout
+{
+
+    // Creates an evaluator for a single search thread. OnnxEvaluator keeps a
+    // per-call input buffer, so concurrent searches must not share one instance.
+    using EvaluatorFactory = std::function<Evaluator()>;
+
+    // Returns an Evaluator that owns its own OnnxEvaluator (and ONNX session).
+    Evaluator makeOnnxEvaluator();
+
+    /**
+     * @brief Merges the roots of independent searches of the same position.
+     *
+     * Each root is read through TreeNode::encode(); its visit distribution and value
+     * are weighted by the number of root visits, so the result has the same
+     * [value, policy...] layout as a single TreeNode::encode().
+     */
+    std::vector<float> mergeRootStatistics(const std::vector<const TreeNode *> &roots);
+
+    /**
+     * @brief Returns the move with the largest share of visits in an encoded root.
+     * @param encoded A vector in the TreeNode::encode() layout.
+     * @return The move index, or -1 if no move has been visited.
+     */
+    int selectMove(const std::vector<float> &encoded);
+
+    // Binds the calling thread to `cpu`; returns false where that isn't supported.
+    bool pinCurrentThread(int cpu);
+
+    /**
+     * @brief Root parallelisation: K independent trees searched on K threads.
+     *
+     * Every tree has its own evaluator and its own PUCT noise stream, so the threads
+     * share nothing and need no synchronisation until their roots are merged.
+     *
+     * Every tree also takes its nodes from its own NodePool, kept across searches. A
+     * NodePool is a free list, not an allocator: nodes it lacks come from the global
+     * heap, on the thread that searches the tree, so the first search and any search
+     * that grows a tree beyond its earlier size still allocate there. Each thread
+     * releases its tree back to its own pool before it finishes, and later searches of
+     * up to that size reuse those nodes without allocating. Page placement is left to
+     * the heap and the kernel; pinning only keeps every tree on one CPU. Nothing here is
+     * NUMA-aware: the pools are per-tree free lists, with optional thread pinning.
+     */
+    class RootParallelSearch
+    {
+    public:
+        /**
+         * @param numTrees Number of independent trees (and threads).
+         * @param evaluatorFactory Called once per tree, on the constructing thread.
+         * @param seed Base seed; tree k draws its PUCT noise from a stream derived from (seed, k),
+         *        so the same seed gives the same trees whatever the thread scheduling.
+         */
+        RootParallelSearch(int numTrees, const EvaluatorFactory &evaluatorFactory, std::uint32_t seed);
+
+        // Same as above, with a base seed drawn from std::random_device.
+        RootParallelSearch(int numTrees, const EvaluatorFactory &evaluatorFactory);
+
+        /**
+         * @brief Searches `state` with every tree and merges the root statistics. Throws
+         * std::invalid_argument if `expansionsPerTree` is less than one or the game is over.
+         * @param expansionsPerTree Number of MonteCarloTreeSearch::expand() calls per tree;
+         *        a tree stops early once its root is proven.
+         * @return Merged root statistics in the TreeNode::encode() layout.
+         */
+        std::vector<float> search(const GameState &state, int expansionsPerTree);
+
+        int getNumTrees() const { return static_cast<int>(evaluators_.size()); }
+
+        // Restarts every tree's noise stream from `seed`, as if newly constructed with it.
+        void reseed(std::uint32_t seed);
+
+        // Pins the thread of tree k to CPU k (modulo the CPUs available). The calling thread
+        // then only waits, so its own affinity is left alone. Off by default.
+        void setThreadPinning(bool pin) { pin_threads_ = pin; }
+
+        // Takes every tree's nodes from its own NodePool (the default), or, when disabled,
+        // straight from the global heap, for comparison.
+        void setNodePools(bool enabled) { node_pools_ = enabled; }
+
+        // The node pool of tree `tree`.
+        const NodePool &getNodePool(int tree) const { return *pools_.at(tree); }
+
+        // The statistics of the last search, summed over the trees.
+        const SearchStats &getLastStats() const { return last_stats_; }
+
+    private:
+        std::vector<Evaluator> evaluators_;
+        std::vector<PredictiveUpperConfidenceBound> strategies_;
+        std::vector<std::unique_ptr<NodePool>> pools_;
+        bool pin_threads_ = false;
+        bool node_pools_ = true;
+        SearchStats last_stats_;
+    };
+
+} // namespace scout
+
+#endif // WASM_SCOUT_LIB_SEARCH_H
@@ -0,0 +1,1198 @@
+#include "lib/search.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+
+#include "benchmark/benchmark.h"
+#include "lib/anytime_search.h"
+#include "lib/coroutine_search.h"
+#include "lib/endgame_solver.h"
+#include "lib/evaluation_cache.h"
+#include "lib/evaluation_table.h"
+#include "lib/gumbel_search.h"
+#include "lib/inference_server.h"
+#include "lib/pipelined_search.h"
+#include "lib/tree_snapshot.h"
+
+namespace scout
+{
+    namespace
+    {
+        // An early middlegame position, reached by the opening of MonteCarloTreeSearchTest.
+        std::unique_ptr<GameState> middlegamePosition()
+        {
+            auto state = std::make_unique<GameState>();
+            return state->move(8)->move(1)->move(7)->move(3);
+        }
+
+        // Picks a move for the player to move in the given state.
+        using MovePicker = std::function<int(const GameState &)>;
+
+        // Plays one game from the initial position and returns the winner.
+        Player playGame(const MovePicker &playerOne, const MovePicker &playerTwo)
+        {
+            auto state = std::make_unique<GameState>();
+            while (!state->isGameOver())
+            {
+                const MovePicker &picker = state->getCurrentPlayer() == Player::ONE ? playerOne : playerTwo;
+                state = state->move(picker(*state));
+            }
+            return state->getWinner().value_or(Player::NONE);
+        }
+
+        // Plays `games` games, alternating colours, and returns the score of `candidate`
+        // (a win counts 1, a tie 0.5) as a fraction of the games played.
+        double playMatch(const MovePicker &candidate, const MovePicker &baseline, int games)
+        {
+            double score = 0.0;
+            for (int game = 0; game < games; ++game)
+            {
+                const bool candidateFirst = game % 2 == 0;
+                const Player winner = candidateFirst ? playGame(candidate, baseline) : playGame(baseline, candidate);
+                if (winner == Player::NONE)
+                {
+                    score += 0.5;
+                }
+                else if ((winner == Player::ONE) == candidateFirst)
+                {
+                    score += 1.0;
+                }
+            }
+            return score / games;
+        }
+
+        template <typename Search>
+        std::vector<float> singleTreeSearch(Search &mcts, const GameState &state, int expansions)
+        {
+            TreeNode root(std::make_unique<GameState>(state), GameState::NUM_MOVES);
+            for (int i = 0; i < expansions; ++i)
+            {
+                mcts.expand(&root);
+            }
+            return root.encode();
+        }
+
+        // Positions from plies 4 to 28 of a few pseudo-random games, for suites of searches.
+        std::vector<GameState> positionSuite()
+        {
+            std::vector<GameState> suite;
+            for (std::uint32_t seed = 1; seed <= 4; ++seed)
+            {
+                std::mt19937 random_generator(seed);
+                auto state = std::make_unique<GameState>();
+                for (int ply = 1; ply <= 28 && !state->isGameOver(); ++ply)
+                {
+                    std::vector<int> moves;
+                    for (int move = 0; move < GameState::NUM_MOVES; ++move)
+                    {
+                        if (state->isMoveAllowed(move))
+                        {
+                            moves.push_back(move);
+                        }
+                    }
+                    state = state->move(moves[random_generator() % moves.size()]);
+                    if (ply % 6 == 4 && !state->isGameOver())
+                    {
+                        suite.push_back(*state);
+                    }
+                }
+            }
+            return suite;
+        }
+
+        EvaluatorFactory uniformEvaluatorFactory()
+        {
+            return []() -> Evaluator
+            { return ZeroValueUniformEvaluator(GameState::NUM_MOVES); };
+        }
+
+        // PUCT selection as it was before the packed kernel: nine gamma variates from
+        // std::mt19937 on every call and a scalar loop in double precision.
+        class ScalarPuct
+        {
+        public:
+            int operator()(const TreeNode &node)
+            {
+                double noise[GameState::NUM_MOVES];
+                double sum = 0.0;
+                for (double &variate : noise)
+                {
+                    variate = gamma_(generator_);
+                    sum += variate;
+                }
+                const double parent_visits_sqrt = std::sqrt(1.0 + node.getVisits() + node.getVirtualLoss());
+                const auto &children = node.getChildStates();
+                const auto &policy = node.evaluation().getPolicy();
+                const Player player = node.state().getCurrentPlayer();
+                float max_value = -std::numeric_limits<float>::max();
+                int index_of_max = 0;
+                for (size_t i = 0; i < children.size(); ++i)
+                {
+                    if (children[i] == nullptr || children[i]->isProven())
+                    {
+                        continue;
+                    }
+                    const float prior = policy[i] * 0.75f + 0.25f * static_cast<float>(noise[i] / sum);
+                    const float value = children[i]->getAverageValue().getValue(player) +
+                                        4.0f * static_cast<float>(prior * parent_visits_sqrt / (1.0 + children[i]->getVisits()));
+                    if (value > max_value)
+                    {
+                        max_value = value;
+                        index_of_max = static_cast<int>(i);
+                    }
+                }
+                return index_of_max;
+            }
+
+        private:
+            std::mt19937 generator_{1};
+            std::gamma_distribution<double> gamma_{1.0, 1.0};
+        };
+    }
+
+    // Single tree with the ONNX evaluator; range(0) is the number of expansions.
+    void BM_SingleTreeSearch(benchmark::State &state)
+    {
+        const int expansions = static_cast<int>(state.range(0));
+        auto position = middlegamePosition();
+        PredictiveUpperConfidenceBound strategy(1);
+        MonteCarloTreeSearch mcts(std::ref(strategy), makeOnnxEvaluator());
+
+        for (auto _ : state)
+        {
+            // Every iteration grows the same tree, so timings compare across commits.
+            strategy.reseed(1);
+            benchmark::DoNotOptimize(singleTreeSearch(mcts, *position, expansions));
+        }
+        state.counters["expansions"] = benchmark::Counter(
+            static_cast<double>(expansions), benchmark::Counter::kIsIterationInvariantRate);
+    }
+    BENCHMARK(BM_SingleTreeSearch)->Arg(2000)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+    // Dynamic (0) against static (1) dispatch of the strategy and the evaluator: 2000
+    // expansions with the uniform evaluator, so selection and expansion dominate.
+    void BM_StaticDispatchSearch(benchmark::State &state)
+    {
+        const int expansions = 2000;
+        auto position = middlegamePosition();
+        PredictiveUpperConfidenceBound strategy(1);
+        MonteCarloTreeSearch dynamicSearch(std::ref(strategy), ZeroValueUniformEvaluator(GameState::NUM_MOVES));
+        BasicMonteCarloTreeSearch staticSearch(std::ref(strategy), ZeroValueUniformEvaluator(GameState::NUM_MOVES));
+
+        for (auto _ : state)
+        {
+            strategy.reseed(1);
+            if (state.range(0) == 0)
+            {
+                benchmark::DoNotOptimize(singleTreeSearch(dynamicSearch, *position, expansions));
+            }
+            else
+            {
+                benchmark::DoNotOptimize(singleTreeSearch(staticSearch, *position, expansions));
+            }
+        }
+        state.counters["expansions"] = benchmark::Counter(
+            static_cast<double>(expansions), benchmark::Counter::kIsIterationInvariantRate);
+    }
+    BENCHMARK(BM_StaticDispatchSearch)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+    // Trees of 2000 expansions grown and discarded, with nodes from the heap (0) or
+    // recycled through a NodePool (1).
+    void BM_NodePoolSearch(benchmark::State &state)
+    {
+        const int expansions = 2000;
+        auto position = middlegamePosition();
+        PredictiveUpperConfidenceBound strategy(1);
+        MonteCarloTreeSearch mcts(std::ref(strategy), ZeroValueUniformEvaluator(GameState::NUM_MOVES));
+        NodePool pool;
+        if (state.range(0) == 1)
+        {
+            mcts.setNodePool(&pool);
+        }
+
+        for (auto _ : state)
+        {
+            strategy.reseed(1);
+            std::shared_ptr<TreeNode> root = pool.acquire(*position);
+            for (int i = 0; i < expansions; ++i)
+            {
+                mcts.expand(root.get());
+            }
+            benchmark::DoNotOptimize(root->getVisits());
+        }
+        state.counters["expansions"] = benchmark::Counter(
+            static_cast<double>(expansions), benchmark::Counter::kIsIterationInvariantRate);
+    }
+    BENCHMARK(BM_NodePoolSearch)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+    namespace
+    {
+        // A cheap stand-in for the network with uneven priors: a softmax over the score
+        // gains of GameStateMoveValuesEstimator, and a value from the score difference.
+        void heuristicEvaluator(const std::vector<TreeNode *> &nodes)
+        {
+            const GameStateMoveValuesEstimator estimator;
+            for (TreeNode *node : nodes)
+            {
+                if (node == nullptr || node->state().isGameOver())
+                {
+                    continue;
+                }
+                const GameState &position = node->state();
+                const std::vector<float> gains = estimator.estimateMoveValues(position);
+                std::vector<float> &policy = node->evaluation().getPolicy();
+                float total = 0.0f;
+                for (int move = 0; move < GameState::NUM_MOVES; ++move)
+                {
+                    policy[move] = position.isMoveAllowed(move) ? std::exp(20.0f * gains[move]) : 0.0f;
+                    total += policy[move];
+                }
+                for (float &prior : policy)
+                {
+                    prior /= total;
+                }
+                const int lead = position.getCurrentPlayer() == Player::ONE
+                                     ? position.getScoreOne() - position.getScoreTwo()
+                                     : position.getScoreTwo() - position.getScoreOne();
+                node->evaluation().setValue(std::tanh(static_cast<float>(lead) / 20.0f));
+            }
+        }
+    }
+
+    // Trees of 20000 expansions with the heuristic evaluator and float (0) or fp16 (1)
+    // priors, grown from a NodePool. nodes_per_gb divides the pool's live nodes by its
+    // byte counter; held_bytes_per_node is countBytes() of the tree, from the buffers the
+    // nodes actually hold. Neither includes allocator overhead.
+    void BM_CompactPriorsSearch(benchmark::State &state)
+    {
+        const bool compact = state.range(0) == 1;
+        const int expansions = 20000;
+        auto position = middlegamePosition();
+        PredictiveUpperConfidenceBound strategy(1);
+        MonteCarloTreeSearch mcts(std::ref(strategy), heuristicEvaluator);
+        NodePool pool;
+        mcts.setNodePool(&pool);
+        mcts.setCompactPriors(compact);
+
+        size_t nodes = 0;
+        size_t pool_bytes = 0;
+        size_t held_bytes = 0;
+        for (auto _ : state)
+        {
+            strategy.reseed(1);
+            std::shared_ptr<TreeNode> root = pool.acquire(*position);
+            for (int i = 0; i < expansions; ++i)
+            {
+                mcts.expand(root.get());
+            }
+            nodes = pool.getLiveNodes();
+            pool_bytes = pool.getBytesInUse();
+            held_bytes = countBytes(*root);
+        }
+        state.counters["simulations"] = benchmark::Counter(
+            static_cast<double>(expansions), benchmark::Counter::kIsIterationInvariantRate);
+        state.counters["nodes"] = static_cast<double>(nodes);
+        state.counters["nodes_per_gb"] = static_cast<double>(nodes) * static_cast<double>(size_t{1} << 30) / pool_bytes;
+        state.counters["held_bytes_per_node"] = static_cast<double>(held_bytes) / nodes;
+    }
+    BENCHMARK(BM_CompactPriorsSearch)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+    // Strength check at equal simulations: fp16 priors against float priors, 400
+    // simulations per move with the heuristic evaluator. A score near 0.5 means the
+    // reduced precision costs no strength.
+    void BM_CompactPriorsMatch(benchmark::State &state)
+    {
+        const int expansions = 400;
+        const int games = 20;
+
+        PredictiveUpperConfidenceBound candidateStrategy(1);
+        MonteCarloTreeSearch candidateSearch(std::ref(candidateStrategy), heuristicEvaluator);
+        candidateSearch.setCompactPriors(true);
+        PredictiveUpperConfidenceBound baselineStrategy(2);
+        MonteCarloTreeSearch baselineSearch(std::ref(baselineStrategy), heuristicEvaluator);
+
+        MovePicker candidate = [&](const GameState &position)
+        { return selectMove(singleTreeSearch(candidateSearch, position, expansions)); };
+        MovePicker baseline = [&](const GameState &position)
+        { return selectMove(singleTreeSearch(baselineSearch, position, expansions)); };
+
+        double score = 0.0;
+        for (auto _ : state)
+        {
+            score = playMatch(candidate, baseline, games);
+        }
+        state.counters["score"] = score;
+    }
+    BENCHMARK(BM_CompactPriorsMatch)->Unit(benchmark::kSecond)->Iterations(1);
+
+    // 2000 simulations on every position of the suite with an expansion threshold of
+    // range(0) visits. rows_per_simulation is what the ONNX model would evaluate; the
+    // heuristic evaluator stands in for it, as the rows don't depend on the model.
+    void BM_ExpansionThreshold(benchmark::State &state)
+    {
+        const int threshold = static_cast<int>(state.range(0));
+        const std::vector<GameState> suite = positionSuite();
+        PredictiveUpperConfidenceBound strategy(1);
+        MonteCarloTreeSearch mcts(std::ref(strategy), heuristicEvaluator);
+        mcts.setExpansionThreshold(threshold);
+
+        for (auto _ : state)
+        {
+            strategy.reseed(1);
+            mcts.resetStats();
+            for (const GameState &position : suite)
+            {
+                benchmark::DoNotOptimize(singleTreeSearch(mcts, position, 2000));
+            }
+        }
+        const SearchStats &stats = mcts.getStats();
+        state.counters["rows_per_simulation"] = static_cast<double>(stats.evaluatedRows) / stats.simulations;
+        state.counters["deferred"] = static_cast<double>(stats.deferredExpansions) / stats.simulations;
+        state.counters["simulations"] = benchmark::Counter(
+            static_cast<double>(suite.size() * 2000), benchmark::Counter::kIsIterationInvariantRate);
+    }
+    BENCHMARK(BM_ExpansionThreshold)->Arg(0)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+    // Strength of an expansion threshold of range(0) visits against immediate expansion,
+    // with the heuristic evaluator. range(1) = 0 gives both 400 simulations per move;
+    // range(1) = 1 gives the candidate as many evaluated rows as the baseline used instead.
+    void BM_ExpansionThresholdMatch(benchmark::State &state)
+    {
+        const int threshold = static_cast<int>(state.range(0));
+        const bool equalRows = state.range(1) == 1;
+        const int expansions = 400;
+        const int games = 20;
+
+        PredictiveUpperConfidenceBound candidateStrategy(1);
+        MonteCarloTreeSearch candidateSearch(std::ref(candidateStrategy), heuristicEvaluator);
+        candidateSearch.setExpansionThreshold(threshold);
+        PredictiveUpperConfidenceBound baselineStrategy(2);
+        MonteCarloTreeSearch baselineSearch(std::ref(baselineStrategy), heuristicEvaluator);
+
+        std::uint64_t baseline_rows = 0;
+        MovePicker baseline = [&](const GameState &position)
+        {
+            const std::uint64_t before = baselineSearch.getStats().evaluatedRows;
+            const int move = selectMove(singleTreeSearch(baselineSearch, position, expansions));
+            baseline_rows = baselineSearch.getStats().evaluatedRows - before;
+            return move;
+        };
+        MovePicker candidate = [&](const GameState &position)
+        {
+            if (!equalRows)
+            {
+                return selectMove(singleTreeSearch(candidateSearch, position, expansions));
+            }
+            // The rows of the baseline's last search, or of a typical one before its first.
+            const std::uint64_t budget = baseline_rows == 0 ? expansions * 8 : baseline_rows;
+            const std::uint64_t start = candidateSearch.getStats().evaluatedRows;
+            TreeNode root(std::make_unique<GameState>(position), GameState::NUM_MOVES);
+            // At least two simulations, so that some root move has a visit.
+            for (int i = 0; i < 20 * expansions && !root.isProven() &&
+                            (i < 2 || candidateSearch.getStats().evaluatedRows - start < budget);
+                 ++i)
+            {
+                candidateSearch.expand(&root);
+            }
+            return selectMove(root.encode());
+        };
+
+        double score = 0.0;
+        for (auto _ : state)
+        {
+            score = playMatch(candidate, baseline, games);
+        }
+        const SearchStats &stats = candidateSearch.getStats();
+        state.counters["score"] = score;
+        state.counters["rows_per_simulation"] = static_cast<double>(stats.evaluatedRows) / stats.simulations;
+    }
+    BENCHMARK(BM_ExpansionThresholdMatch)
+        ->ArgsProduct({{1, 2, 4}, {0, 1}})
+        ->Unit(benchmark::kSecond)
+        ->Iterations(1);
+
+    namespace
+    {
+        // A stand-in for the model that costs 20us per call plus 1us per row, either
+        // waiting like an accelerator (`busy` false) or computing on a core (true).
+        Evaluator modelCostEvaluator(bool busy)
+        {
+            ZeroValueUniformEvaluator uniform(GameState::NUM_MOVES);
+            return [uniform, busy](const std::vector<TreeNode *> &nodes)
+            {
+                const auto cost = std::chrono::microseconds(20 + static_cast<int>(nodes.size()));
+                if (busy)
+                {
+                    const auto end = std::chrono::steady_clock::now() + cost;
+                    while (std::chrono::steady_clock::now() < end)
+                    {
+                    }
+                }
+                else
+                {
+                    std::this_thread::sleep_for(cost);
+                }
+                uniform(nodes);
+            };
+        }
+    }
+
+    // Simulations per second with an evaluator of realistic cost: the sequential expand()
+    // loop (range(0) == 0), expandBatch() of 8 leaves (1), and a PipelinedSearch of 8
+    // leaves that selects the next batch while one is evaluated (2). range(1) is 0 for an
+    // evaluator that waits, like an accelerator, and 1 for one that computes on a core,
+    // which only overlaps with selection given a second core.
+    void BM_PipelinedSearch(benchmark::State &state)
+    {
+        const int simulations = 2000;
+        const int batchSize = 8;
+        auto position = middlegamePosition();
+        PredictiveUpperConfidenceBound strategy(1);
+        const Evaluator evaluator = modelCostEvaluator(state.range(1) == 1);
+        MonteCarloTreeSearch sequential(std::ref(strategy), evaluator);
+        PipelinedSearch pipelined(std::ref(strategy), evaluator, batchSize);
+
+        std::int64_t done = 0;
+        SearchStats stats;
+        for (auto _ : state)
+        {
+            TreeNode root(std::make_unique<GameState>(*position), GameState::NUM_MOVES);
+            sequential.resetStats();
+            int run = 0;
+            switch (state.range(0))
+            {
+            case 0:
+                for (; run < simulations; ++run)
+                {
+                    sequential.expand(&root);
+                }
+                break;
+            case 1:
+                while (run < simulations)
+                {
+                    run += sequential.expandBatch(&root, batchSize);
+                }
+                break;
+            default:
+                run = pipelined.search(root, simulations);
+            }
+            done += run;
+            stats += state.range(0) == 2 ? pipelined.getLastStats() : sequential.getStats();
+        }
+        state.counters["simulations"] = benchmark::Counter(static_cast<double>(done), benchmark::Counter::kIsRate);
+        state.counters["rowsPerCall"] = static_cast<double>(stats.evaluatedRows) / stats.evaluatorCalls;
+    }
+    BENCHMARK(BM_PipelinedSearch)->ArgsProduct({{0, 1, 2}, {0, 1}})->Unit(benchmark::kMillisecond)->UseRealTime();
+
+    // Selections per second: descents through a tree of 2000 expansions without
+    // expanding or backing up, with the scalar PUCT (0) or the packed kernel (1).
+    void BM_PuctSelection(benchmark::State &state)
+    {
+        auto position = middlegamePosition();
+        PredictiveUpperConfidenceBound strategy(1);
+        MonteCarloTreeSearch mcts(std::ref(strategy), ZeroValueUniformEvaluator(GameState::NUM_MOVES));
+        TreeNode root(std::move(position), GameState::NUM_MOVES);
+        for (int i = 0; i < 2000; ++i)
+        {
+            mcts.expand(&root);
+        }
+
+        ScalarPuct scalar;
+        std::vector<TreeNode *> path;
+        std::int64_t selections = 0;
+        for (auto _ : state)
+        {
+            if (state.range(0) == 0)
+            {
+                selectPath(&root, scalar, path);
+            }
+            else
+            {
+                selectPath(&root, strategy, path);
+            }
+            selections += static_cast<std::int64_t>(path.size()) - 1;
+            benchmark::DoNotOptimize(path.data());
+        }
+        state.SetItemsProcessed(selections);
+    }
+    BENCHMARK(BM_PuctSelection)->Arg(0)->Arg(1);
+
+    // range(0) trees, each with 2000 expansions, so total work grows with the tree count.
+    void BM_RootParallelSearch(benchmark::State &state)
+    {
+        const int trees = static_cast<int>(state.range(0));
+        const int expansionsPerTree = 2000;
+        auto position = middlegamePosition();
+        RootParallelSearch search(trees, makeOnnxEvaluator, 1);
+
+        for (auto _ : state)
+        {
+            search.reseed(1);
+            benchmark::DoNotOptimize(search.search(*position, expansionsPerTree));
+        }
+        state.counters["expansions"] = benchmark::Counter(
+            static_cast<double>(trees * expansionsPerTree), benchmark::Counter::kIsIterationInvariantRate);
+    }
+    BENCHMARK(BM_RootParallelSearch)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+    // Scaling of the tree side of root parallelism: range(0) trees of 2000 expansions with
+    // the uniform evaluator, so node allocation and memory traffic dominate. range(1) selects
+    // 0: shared heap, 1: per-tree node pools, 2: pools with pinned threads.
+    void BM_RootParallelScaling(benchmark::State &state)
+    {
+        const int trees = static_cast<int>(state.range(0));
+        const int mode = static_cast<int>(state.range(1));
+        const int expansionsPerTree = 2000;
+        auto position = middlegamePosition();
+        RootParallelSearch search(trees, uniformEvaluatorFactory(), 1);
+        search.setNodePools(mode >= 1);
+        search.setThreadPinning(mode == 2);
+
+        for (auto _ : state)
+        {
+            search.reseed(1);
+            benchmark::DoNotOptimize(search.search(*position, expansionsPerTree));
+        }
+        state.counters["simulations"] = benchmark::Counter(
+            static_cast<double>(trees * expansionsPerTree), benchmark::Counter::kIsIterationInvariantRate);
+    }
+    BENCHMARK(BM_RootParallelScaling)
+        ->ArgsProduct({{1, 8, 64}, {0, 1, 2}})
+        ->Unit(benchmark::kMillisecond)
+        ->UseRealTime();
+
+    // range(0) trees of 2000 expansions sharing one ONNX session through an InferenceServer.
+    void BM_RootParallelSharedServer(benchmark::State &state)
+    {
+        const int trees = static_cast<int>(state.range(0));
+        const int expansionsPerTree = 2000;
+        auto position = middlegamePosition();
+        InferenceServer server(makeOnnxEvaluator(), 256, std::chrono::microseconds(200));
+        RootParallelSearch search(trees, [&server]
+                                  { return server.evaluator(); }, 1);
+
+        for (auto _ : state)
+        {
+            search.reseed(1);
+            benchmark::DoNotOptimize(search.search(*position, expansionsPerTree));
+        }
+
+        const auto metrics = server.metrics();
+        state.counters["expansions"] = benchmark::Counter(
+            static_cast<double>(trees * expansionsPerTree), benchmark::Counter::kIsIterationInvariantRate);
+        state.counters["rows_per_batch"] = static_cast<double>(metrics.rows) / metrics.batches;
+        state.counters["avg_wait_us"] = static_cast<double>(metrics.totalWait.count()) / metrics.requests;
+    }
+    BENCHMARK(BM_RootParallelSharedServer)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+    // Leaf batching: 2000 simulations per move, range(0) leaves per evaluator call
+    // (1 runs the plain expand() loop).
+    void BM_BatchedSearch(benchmark::State &state)
+    {
+        const int batchSize = static_cast<int>(state.range(0));
+        const int simulations = 2000;
+        auto position = middlegamePosition();
+
+        Evaluator onnx = makeOnnxEvaluator();
+        int64_t calls = 0;
+        int64_t rows = 0;
+        Evaluator counting = [&](const std::vector<TreeNode *> &nodes)
+        {
+            ++calls;
+            rows += static_cast<int64_t>(nodes.size());
+            onnx(nodes);
+        };
+        PredictiveUpperConfidenceBound strategy(1);
+        MonteCarloTreeSearch mcts(std::ref(strategy), counting);
+
+        for (auto _ : state)
+        {
+            TreeNode root(std::make_unique<GameState>(*position), GameState::NUM_MOVES);
+            int done = 0;
+            while (done < simulations)
+            {
+                if (batchSize == 1)
+                {
+                    mcts.expand(&root);
+                    ++done;
+                }
+                else
+                {
+                    done += mcts.expandBatch(&root, std::min(batchSize, simulations - done));
+                }
+            }
+            benchmark::DoNotOptimize(root.encode());
+        }
+        state.counters["calls_per_move"] = static_cast<double>(calls) / state.iterations();
+        state.counters["rows_per_call"] = static_cast<double>(rows) / calls;
+    }
+    BENCHMARK(BM_BatchedSearch)->RangeMultiplier(2)->Range(1, 64)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+    // Coroutine-driven search: 2000 simulations with range(0) simulations in flight.
+    void BM_CoroutineSearch(benchmark::State &state)
+    {
+        const int concurrency = static_cast<int>(state.range(0));
+        auto position = middlegamePosition();
+        PredictiveUpperConfidenceBound strategy(1);
+        CoroutineSearch search(std::ref(strategy), makeOnnxEvaluator());
+
+        int64_t calls = 0;
+        for (auto _ : state)
+        {
+            TreeNode root(std::make_unique<GameState>(*position), GameState::NUM_MOVES);
+            calls += search.search(&root, 2000, concurrency);
+            benchmark::DoNotOptimize(root.encode());
+        }
+        state.counters["calls_per_move"] = static_cast<double>(calls) / state.iterations();
+    }
+    BENCHMARK(BM_CoroutineSearch)->RangeMultiplier(4)->Range(1, 256)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+    // Transposition table off (0) or on (1): 2000 simulations per move with ONNX.
+    void BM_TranspositionSearch(benchmark::State &state)
+    {
+        const bool useTable = state.range(0) != 0;
+        auto position = middlegamePosition();
+
+        Evaluator onnx = makeOnnxEvaluator();
+        int64_t rows = 0;
+        Evaluator counting = [&](const std::vector<TreeNode *> &nodes)
+        {
+            for (TreeNode *node : nodes)
+            {
+                rows += node != nullptr;
+            }
+            onnx(nodes);
+        };
+        PredictiveUpperConfidenceBound strategy(1);
+        MonteCarloTreeSearch mcts(std::ref(strategy), counting);
+        TranspositionTable table;
+
+        for (auto _ : state)
+        {
+            table.clear();
+            mcts.setTranspositionTable(useTable ? &table : nullptr);
+            benchmark::DoNotOptimize(singleTreeSearch(mcts, *position, 2000));
+        }
+        state.counters["rows_per_move"] = static_cast<double>(rows) / state.iterations();
+        state.counters["hit_rate"] = table.getLookups() == 0 ? 0.0 : static_cast<double>(table.getHits()) / table.getLookups();
+    }
+    BENCHMARK(BM_TranspositionSearch)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+    // Strength check at equal simulations: a search with a transposition table against one
+    // without, 400 simulations per move with the uniform evaluator. A score near 0.5 means
+    // the saved evaluations cost no strength.
+    void BM_TranspositionMatch(benchmark::State &state)
+    {
+        const int expansions = 400;
+        const int games = 10;
+
+        PredictiveUpperConfidenceBound candidateStrategy(1);
+        MonteCarloTreeSearch candidateSearch(std::ref(candidateStrategy), ZeroValueUniformEvaluator(GameState::NUM_MOVES));
+        TranspositionTable table;
+        PredictiveUpperConfidenceBound baselineStrategy(2);
+        MonteCarloTreeSearch baselineSearch(std::ref(baselineStrategy), ZeroValueUniformEvaluator(GameState::NUM_MOVES));
+
+        MovePicker candidate = [&](const GameState &position)
+        {
+            table.clear();
+            candidateSearch.setTranspositionTable(&table);
+            return selectMove(singleTreeSearch(candidateSearch, position, expansions));
+        };
+        MovePicker baseline = [&](const GameState &position)
+        { return selectMove(singleTreeSearch(baselineSearch, position, expansions)); };
+
+        double score = 0.0;
+        for (auto _ : state)
+        {
+            score = playMatch(candidate, baseline, games);
+        }
+        state.counters["score"] = score;
+    }
+    BENCHMARK(BM_TranspositionMatch)->Unit(benchmark::kSecond)->Iterations(1);
+
+    // One self-play game with ONNX and 2000 simulations per move, the searches of every move
+    // sharing an EvaluationCache of range(0) KiB. Consecutive searches revisit most of the
+    // previous tree, so the hit rate shows how much of the network work a cache saves.
+    void BM_EvaluationCacheGame(benchmark::State &state)
+    {
+        const size_t budget = static_cast<size_t>(state.range(0)) * 1024;
+
+        Evaluator onnx = makeOnnxEvaluator();
+        int64_t rows = 0;
+        Evaluator counting = [&](const std::vector<TreeNode *> &nodes)
+        {
+            rows += static_cast<int64_t>(nodes.size());
+            onnx(nodes);
+        };
+        EvaluationCache cache(counting, budget);
+        PredictiveUpperConfidenceBound strategy(1);
+        MonteCarloTreeSearch mcts(std::ref(strategy), std::ref(cache));
+
+        MovePicker player = [&](const GameState &position)
+        { return selectMove(singleTreeSearch(mcts, position, 2000)); };
+
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(playGame(player, player));
+        }
+        const double lookups = static_cast<double>(cache.getHits() + cache.getMisses());
+        state.counters["rows_per_game"] = static_cast<double>(rows) / state.iterations();
+        state.counters["hit_rate"] = lookups == 0 ? 0.0 : cache.getHits() / lookups;
+    }
+    BENCHMARK(BM_EvaluationCacheGame)->Arg(64)->Arg(1024)->Arg(16384)->Unit(benchmark::kSecond)->Iterations(1);
+
+    namespace
+    {
+        constexpr std::uint32_t TABLE_KEYS = 1 << 16;
+
+        std::uint64_t tableKey(std::uint32_t index)
+        {
+            return (index + 1) * 0x9e3779b97f4a7c15ULL;
+        }
+
+        // A 4 MiB table of 128Ki slots holding TABLE_KEYS entries, shared by every thread.
+        EvaluationTable &sharedTable()
+        {
+            static EvaluationTable table(4 << 20);
+            static const bool filled = []
+            {
+                const std::vector<float> policy(GameState::NUM_MOVES, 1.0f / GameState::NUM_MOVES);
+                for (std::uint32_t i = 0; i < TABLE_KEYS; ++i)
+                {
+                    table.store(tableKey(i), 0.0f, policy);
+                }
+                return true;
+            }();
+            benchmark::DoNotOptimize(filled);
+            return table;
+        }
+
+        // The same hits served by the mutex-guarded EvaluationCache.
+        EvaluationCache &sharedCache()
+        {
+            static EvaluationCache cache(ZeroValueUniformEvaluator(GameState::NUM_MOVES), 64 << 20);
+            return cache;
+        }
+
+        // Every position two plies from the start, with one node per thread and position.
+        std::vector<std::unique_ptr<TreeNode>> openingNodes()
+        {
+            std::vector<std::unique_ptr<TreeNode>> nodes;
+            for (int first = 0; first < GameState::NUM_MOVES; ++first)
+            {
+                auto state = GameState().move(first);
+                for (int second = 0; second < GameState::NUM_MOVES; ++second)
+                {
+                    if (state->isMoveAllowed(second))
+                    {
+                        nodes.push_back(std::make_unique<TreeNode>(state->move(second), GameState::NUM_MOVES));
+                    }
+                }
+            }
+            return nodes;
+        }
+    }
+
+    // Probes of stored keys from every thread at once; all of them hit.
+    void BM_EvaluationTableProbe(benchmark::State &state)
+    {
+        EvaluationTable &table = sharedTable();
+        EvaluationTable::Entry entry;
+        std::uint32_t index = static_cast<std::uint32_t>(state.thread_index()) * 7919;
+        for (auto _ : state)
+        {
+            index = (index + 40503) % TABLE_KEYS;
+            benchmark::DoNotOptimize(table.probe(tableKey(index), entry));
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_EvaluationTableProbe)->ThreadRange(1, 8)->UseRealTime();
+
+    // Stores over the same keys from every thread at once, so threads overwrite each other.
+    void BM_EvaluationTableStore(benchmark::State &state)
+    {
+        EvaluationTable &table = sharedTable();
+        const std::vector<float> policy(GameState::NUM_MOVES, 1.0f / GameState::NUM_MOVES);
+        std::uint32_t index = static_cast<std::uint32_t>(state.thread_index()) * 7919;
+        for (auto _ : state)
+        {
+            index = (index + 40503) % TABLE_KEYS;
+            table.store(tableKey(index), 0.0f, policy);
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_EvaluationTableStore)->ThreadRange(1, 8)->UseRealTime();
+
+    // Cached evaluations of the 81 positions after two moves per call, from every thread at
+    // once, through the EvaluationCache (range(0) = 0) or the EvaluationTable (range(0) = 1).
+    void BM_SharedEvaluationLookup(benchmark::State &state)
+    {
+        Evaluator evaluator = state.range(0) == 0
+                                  ? Evaluator(std::ref(sharedCache()))
+                                  : sharedTable().evaluator(ZeroValueUniformEvaluator(GameState::NUM_MOVES));
+        auto owned = openingNodes();
+        std::vector<TreeNode *> nodes;
+        for (const auto &node : owned)
+        {
+            nodes.push_back(node.get());
+        }
+        evaluator(nodes);
+
+        for (auto _ : state)
+        {
+            evaluator(nodes);
+        }
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(nodes.size()));
+    }
+    BENCHMARK(BM_SharedEvaluationLookup)->Arg(0)->Arg(1)->ThreadRange(1, 8)->UseRealTime();
+
+    // Early termination over the position suite, 2000 simulations per position with
+    // ONNX: range(0) = 0 runs the full budget, 1 stops once the move is
+    // decided, 2 also prunes unreachable root moves. Every search of a position uses the
+    // same PUCT seed, so "same_move" is the share of moves equal to the full budget's.
+    void BM_EarlyTermination(benchmark::State &state)
+    {
+        const int mode = static_cast<int>(state.range(0));
+        const std::vector<GameState> suite = positionSuite();
+        Evaluator onnx = makeOnnxEvaluator();
+
+        auto searchSuite = [&suite, &onnx](bool stopWhenDecided, bool pruneUnreachable)
+        {
+            std::vector<SearchResult> results;
+            for (const GameState &position : suite)
+            {
+                PredictiveUpperConfidenceBound strategy(1);
+                AnytimeSearch search(std::ref(strategy), onnx);
+                SearchLimits limits;
+                limits.maxSimulations = 2000;
+                limits.stopWhenDecided = stopWhenDecided;
+                limits.pruneUnreachable = pruneUnreachable;
+                results.push_back(search.search(position, limits));
+            }
+            return results;
+        };
+
+        const std::vector<SearchResult> reference = searchSuite(false, false);
+        std::vector<SearchResult> results;
+        for (auto _ : state)
+        {
+            results = searchSuite(mode >= 1, mode >= 2);
+        }
+
+        double simulations = 0.0;
+        double latency = 0.0;
+        double sameMoves = 0.0;
+        for (size_t i = 0; i < suite.size(); ++i)
+        {
+            simulations += results[i].simulations;
+            latency += std::chrono::duration<double, std::milli>(results[i].elapsed).count();
+            sameMoves += results[i].bestMove == reference[i].bestMove;
+        }
+        state.counters["positions"] = static_cast<double>(suite.size());
+        state.counters["saved_simulations"] = 2000.0 - simulations / suite.size();
+        state.counters["latency_ms"] = latency / suite.size();
+        state.counters["same_move"] = sameMoves / suite.size();
+    }
+    BENCHMARK(BM_EarlyTermination)->Arg(0)->Arg(1)->Arg(2)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+    // Strength at small budgets: Gumbel sequential halving with range(0) simulations per
+    // move against PUCT with 2000, with the uniform evaluator. A score near 0.5 means the
+    // Gumbel search keeps the strength of the full budget.
+    void BM_GumbelVsPuctMatch(benchmark::State &state)
+    {
+        const int simulations = static_cast<int>(state.range(0));
+        const int games = 10;
+
+        PredictiveUpperConfidenceBound candidateStrategy(1);
+        GumbelSearch gumbel(std::ref(candidateStrategy), ZeroValueUniformEvaluator(GameState::NUM_MOVES), 1);
+        PredictiveUpperConfidenceBound baselineStrategy(2);
+        MonteCarloTreeSearch puct(std::ref(baselineStrategy), ZeroValueUniformEvaluator(GameState::NUM_MOVES));
+
+        MovePicker candidate = [&](const GameState &position)
+        { return gumbel.search(position, simulations).bestMove; };
+        MovePicker baseline = [&](const GameState &position)
+        { return selectMove(singleTreeSearch(puct, position, 2000)); };
+
+        double score = 0.0;
+        for (auto _ : state)
+        {
+            score = playMatch(candidate, baseline, games);
+        }
+        state.counters["score"] = score;
+    }
+    BENCHMARK(BM_GumbelVsPuctMatch)->Arg(200)->Arg(400)->Unit(benchmark::kSecond)->Iterations(1);
+
+    // Strength at equal wall time: range(0) trees of 200 expansions each against one tree
+    // of 200 expansions. The uniform evaluator keeps whole games cheap enough to benchmark,
+    // which isolates the search scheme from the network.
+    void BM_RootParallelVsSingleTreeMatch(benchmark::State &state)
+    {
+        const int trees = static_cast<int>(state.range(0));
+        const int expansions = 200;
+        const int games = 10;
+
+        RootParallelSearch parallel(trees, uniformEvaluatorFactory(), 1);
+        PredictiveUpperConfidenceBound strategy(2);
+        MonteCarloTreeSearch single(std::ref(strategy), ZeroValueUniformEvaluator(GameState::NUM_MOVES));
+
+        MovePicker candidate = [&](const GameState &position)
+        { return selectMove(parallel.search(position, expansions)); };
+        MovePicker baseline = [&](const GameState &position)
+        { return selectMove(singleTreeSearch(single, position, expansions)); };
+
+        double score = 0.0;
+        for (auto _ : state)
+        {
+            score = playMatch(candidate, baseline, games);
+        }
+        state.counters["score"] = score;
+    }
+    BENCHMARK(BM_RootParallelVsSingleTreeMatch)->Arg(2)->Arg(4)->Unit(benchmark::kSecond)->Iterations(1);
+
+    namespace
+    {
+        // A tree of about `nodes` nodes, grown once per size with the uniform evaluator and
+        // written to a temporary snapshot shared by the snapshot benchmarks.
+        struct SnapshotFixture
+        {
+            std::shared_ptr<TreeNode> root;
+            std::string path;
+        };
+
+        const SnapshotFixture &snapshotFixture(std::int64_t nodes)
+        {
+            static std::map<std::int64_t, SnapshotFixture> fixtures;
+            SnapshotFixture &fixture = fixtures[nodes];
+            if (fixture.root == nullptr)
+            {
+                PredictiveUpperConfidenceBound strategy(1);
+                MonteCarloTreeSearch mcts(std::ref(strategy), ZeroValueUniformEvaluator(GameState::NUM_MOVES));
+                fixture.root = std::make_shared<TreeNode>(middlegamePosition(), GameState::NUM_MOVES);
+                // An expansion adds about seven children on average.
+                for (std::int64_t i = 0; i < nodes / (GameState::NUM_MOVES - 2); ++i)
+                {
+                    mcts.expand(fixture.root.get());
+                }
+                fixture.path = "/tmp/search_benchmark_" + std::to_string(nodes) + ".snapshot";
+                writeSnapshot(*fixture.root, fixture.path);
+            }
+            return fixture;
+        }
+
+        void setSnapshotCounters(benchmark::State &state, const SnapshotFixture &fixture)
+        {
+            const double nodes = static_cast<double>(countNodes(*fixture.root));
+            state.counters["nodes"] = nodes;
+            state.counters["MB"] = nodes * sizeof(SnapshotNode) / (1 << 20);
+        }
+    }
+
+    // Writing the whole tree in one streaming pass.
+    void BM_SnapshotWrite(benchmark::State &state)
+    {
+        const SnapshotFixture &fixture = snapshotFixture(state.range(0));
+        for (auto _ : state)
+        {
+            writeSnapshot(*fixture.root, fixture.path);
+        }
+        setSnapshotCounters(state, fixture);
+    }
+    BENCHMARK(BM_SnapshotWrite)->Arg(1 << 20)->Arg(4 << 20)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+    // Opening a snapshot and reading the root's best move: the load time when the tree
+    // is only inspected, which doesn't grow with its size.
+    void BM_SnapshotOpen(benchmark::State &state)
+    {
+        const SnapshotFixture &fixture = snapshotFixture(state.range(0));
+        for (auto _ : state)
+        {
+            TreeSnapshot snapshot(fixture.path);
+            const SnapshotNode &root = snapshot.getRoot();
+            int best = 0;
+            for (int move = 0; move < GameState::NUM_MOVES; ++move)
+            {
+                if (root.children[move] != SnapshotNode::NO_CHILD &&
+                    snapshot.getNode(root.children[move]).getVisits() > best)
+                {
+                    best = snapshot.getNode(root.children[move]).getVisits();
+                }
+            }
+            benchmark::DoNotOptimize(best);
+        }
+        setSnapshotCounters(state, fixture);
+    }
+    BENCHMARK(BM_SnapshotOpen)->Arg(1 << 20)->Arg(4 << 20)->Unit(benchmark::kMicrosecond)->UseRealTime();
+
+    // Opening a snapshot and touching every record through the mapping.
+    void BM_SnapshotScan(benchmark::State &state)
+    {
+        const SnapshotFixture &fixture = snapshotFixture(state.range(0));
+        for (auto _ : state)
+        {
+            TreeSnapshot snapshot(fixture.path);
+            std::int64_t visits = 0;
+            for (std::uint32_t i = 0; i < snapshot.size(); ++i)
+            {
+                visits += snapshot.getNode(i).getVisits();
+            }
+            benchmark::DoNotOptimize(visits);
+        }
+        setSnapshotCounters(state, fixture);
+    }
+    BENCHMARK(BM_SnapshotScan)->Arg(1 << 20)->Arg(4 << 20)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+    // Rebuilding the TreeNodes from a snapshot to resume the search, with nodes from the
+    // heap (range(1) == 0) or from a warm NodePool (1).
+    void BM_SnapshotRestore(benchmark::State &state)
+    {
+        const SnapshotFixture &fixture = snapshotFixture(state.range(0));
+        TreeSnapshot snapshot(fixture.path);
+        NodePool pool;
+        for (auto _ : state)
+        {
+            std::shared_ptr<TreeNode> root = snapshot.restore(state.range(1) == 1 ? &pool : nullptr);
+            benchmark::DoNotOptimize(root->getVisits());
+            state.PauseTiming();
+            root.reset();
+            state.ResumeTiming();
+        }
+        setSnapshotCounters(state, fixture);
+    }
+    BENCHMARK(BM_SnapshotRestore)->Args({1 << 20, 0})->Args({1 << 20, 1})->Args({4 << 20, 0})->Unit(benchmark::kMillisecond)->UseRealTime();
+
+    namespace
+    {
+        // An endgame suite: positions of random games once at most `stones` stones are
+        // left, with their results under perfect play for the player to move (1, 0, -1).
+        struct EndgamePosition
+        {
+            GameState state;
+            int result;
+            // The result of each move for the player to move, or -2 if it isn't legal.
+            std::array<int, GameState::NUM_MOVES> moveResults;
+        };
+
+        int resultFor(Player winner, Player player)
+        {
+            return winner == Player::NONE ? 0 : (winner == player ? 1 : -1);
+        }
+
+        const std::vector<EndgamePosition> &endgameSuite()
+        {
+            static const std::vector<EndgamePosition> suite = []
+            {
+                const int positions = 50;
+                const int stones = 12;
+                EndgameSolver oracle(ZeroValueUniformEvaluator(GameState::NUM_MOVES), stones, 1 << 20);
+                std::mt19937 random(7);
+                std::vector<EndgamePosition> result;
+                while (static_cast<int>(result.size()) < positions)
+                {
+                    GameState state;
+                    while (!state.isGameOver() && EndgameSolver::stonesOnBoard(state) > stones)
+                    {
+                        std::vector<int> moves;
+                        for (int move = 0; move < GameState::NUM_MOVES; ++move)
+                        {
+                            if (state.isMoveAllowed(move))
+                            {
+                                moves.push_back(move);
+                            }
+                        }
+                        state = state.afterMove(moves[random() % moves.size()]);
+                    }
+                    if (state.isGameOver())
+                    {
+                        continue;
+                    }
+
+                    const Player mover = state.getCurrentPlayer();
+                    EndgamePosition position{state, 0, {}};
+                    position.moveResults.fill(-2);
+                    bool solved = true;
+                    int best = -1;
+                    int worst = 1;
+                    for (int move = 0; move < GameState::NUM_MOVES && solved; ++move)
+                    {
+                        if (!state.isMoveAllowed(move))
+                        {
+                            continue;
+                        }
+                        const std::optional<Player> winner = oracle.solve(state.afterMove(move));
+                        solved = winner.has_value();
+                        if (solved)
+                        {
+                            position.moveResults[move] = resultFor(*winner, mover);
+                            best = std::max(best, position.moveResults[move]);
+                            worst = std::min(worst, position.moveResults[move]);
+                        }
+                    }
+                    // Only positions where the choice of move matters tell the searches apart.
+                    if (solved && best != worst)
+                    {
+                        position.result = best;
+                        result.push_back(position);
+                    }
+                }
+                return result;
+            }();
+            return suite;
+        }
+    }
+
+    // Searches of 200 expansions on the endgame suite, with the uniform evaluator standing
+    // in for the model alone (range(0) == 0) or behind an EndgameSolver for leaves with
+    // at most range(0) stones. Reports the model rows per search and the fraction of
+    // positions where the chosen move keeps the result of perfect play.
+    void BM_EndgameSolverSuite(benchmark::State &state)
+    {
+        const int expansions = 200;
+        const int maxStones = static_cast<int>(state.range(0));
+        const std::vector<EndgamePosition> &suite = endgameSuite();
+
+        std::uint64_t rows = 0;
+        Evaluator model = [&rows](const std::vector<TreeNode *> &nodes)
+        {
+            for (TreeNode *node : nodes)
+            {
+                rows += node != nullptr ? 1 : 0;
+            }
+            ZeroValueUniformEvaluator(GameState::NUM_MOVES)(nodes);
+        };
+        EndgameSolver solver(model, maxStones);
+        PredictiveUpperConfidenceBound strategy(1);
+        MonteCarloTreeSearch mcts(std::ref(strategy), maxStones > 0 ? Evaluator(std::ref(solver)) : model);
+
+        int correct = 0;
+        int searches = 0;
+        for (auto _ : state)
+        {
+            for (const EndgamePosition &position : suite)
+            {
+                TreeNode root(std::make_unique<GameState>(position.state), GameState::NUM_MOVES);
+                for (int i = 0; i < expansions && !root.isProven(); ++i)
+                {
+                    mcts.expand(&root);
+                }
+                correct += position.moveResults[root.getBestMove()] == position.result ? 1 : 0;
+                ++searches;
+            }
+        }
+        state.counters["accuracy"] = static_cast<double>(correct) / searches;
+        state.counters["modelRows"] = static_cast<double>(rows) / searches;
+        state.counters["solved"] = static_cast<double>(solver.getSolved()) / searches;
+        state.counters["solverPositions"] = static_cast<double>(solver.getSearchedPositions()) / searches;
+    }
+    BENCHMARK(BM_EndgameSolverSuite)->Arg(0)->Arg(6)->Arg(9)->Arg(12)->Unit(benchmark::kMillisecond)->Iterations(1);
+
+} // namespace scout
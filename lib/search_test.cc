@@ -0,0 +1,153 @@
+#include "lib/search.h"
+
+#include "gtest/gtest.h"
+
+namespace scout
+{
+
+    namespace
+    {
+        EvaluatorFactory uniformEvaluatorFactory()
+        {
+            return []() -> Evaluator
+            { return ZeroValueUniformEvaluator(GameState::NUM_MOVES); };
+        }
+
+        // Returns the position of MonteCarloTreeSearchTest, where move 8 wins at once.
+        std::unique_ptr<GameState> shortestGamePosition()
+        {
+            auto state = std::make_unique<GameState>();
+            return state->move(8)->move(1)->move(7)->move(3)->move(6)->move(3)->move(4)->move(1)->move(8)->move(8);
+        }
+    }
+
+    TEST(MergeRootStatisticsTest, WeightsTreesByRootVisits)
+    {
+        Evaluator dummy_evaluator = [](const std::vector<TreeNode *> &) {};
+
+        TreeNode first(std::make_unique<GameState>(), GameState::NUM_MOVES);
+        first.initChildren(dummy_evaluator);
+        first.getAverageValue().fromEvaluation(Player::ONE, 0.5f);
+        first.update(Player::ONE, AverageValue());
+        first.getChildStates()[0]->update(Player::ONE, AverageValue());
+
+        TreeNode second(std::make_unique<GameState>(), GameState::NUM_MOVES);
+        second.initChildren(dummy_evaluator);
+        second.getAverageValue().fromEvaluation(Player::ONE, -1.0f);
+        for (int i = 0; i < 3; ++i)
+        {
+            second.update(Player::TWO, AverageValue());
+            second.getChildStates()[1]->update(Player::TWO, AverageValue());
+        }
+
+        auto merged = mergeRootStatistics({&first, &second});
+
+        ASSERT_EQ(merged.size(), 1 + GameState::NUM_MOVES);
+        // Root values 0.5 (1 visit) and -1.0 (3 visits).
+        EXPECT_FLOAT_EQ(merged[0], (0.5f * 1 - 1.0f * 3) / 4);
+        EXPECT_FLOAT_EQ(merged[1], 1.0f / 4.0f);
+        EXPECT_FLOAT_EQ(merged[2], 3.0f / 4.0f);
+        EXPECT_FLOAT_EQ(merged[3], 0.0f);
+        EXPECT_EQ(selectMove(merged), 1);
+    }
+
+    TEST(SelectMoveTest, NoVisitsSelectsNothing)
+    {
+        EXPECT_EQ(selectMove({0.3f, 0.0f, 0.0f}), -1);
+        EXPECT_EQ(selectMove({0.3f, 0.2f, 0.8f}), 1);
+    }
+
+    TEST(RootParallelSearchTest, MergesAllTrees)
+    {
+        RootParallelSearch search(4, uniformEvaluatorFactory(), 7);
+        EXPECT_EQ(search.getNumTrees(), 4);
+
+        auto encoded = search.search(*shortestGamePosition(), 500);
+
+        ASSERT_EQ(encoded.size(), 1 + GameState::NUM_MOVES);
+        float policy_sum = 0.0f;
+        for (size_t i = 1; i < encoded.size(); ++i)
+        {
+            policy_sum += encoded[i];
+        }
+        EXPECT_NEAR(policy_sum, 1.0f, 1e-5);
+        EXPECT_EQ(selectMove(encoded), 8);
+
+        // Every tree stops once its root is proven, after at most 500 simulations.
+        const SearchStats &stats = search.getLastStats();
+        EXPECT_GT(stats.simulations, 0u);
+        EXPECT_LE(stats.simulations, 4u * 500);
+        EXPECT_GE(stats.nodes, 4u);
+    }
+
+    TEST(RootParallelSearchTest, RejectsEmptyForest)
+    {
+        EXPECT_THROW(RootParallelSearch(0, uniformEvaluatorFactory(), 7), std::invalid_argument);
+    }
+
+    TEST(RootParallelSearchTest, RejectsEmptyBudgetsAndFinishedGames)
+    {
+        RootParallelSearch search(2, uniformEvaluatorFactory(), 7);
+        EXPECT_THROW(search.search(GameState(), 0), std::invalid_argument);
+        EXPECT_THROW(search.search(GameState(), -5), std::invalid_argument);
+        EXPECT_THROW(search.search(*shortestGamePosition()->move(8), 10), std::invalid_argument);
+
+        // The forest is still usable.
+        EXPECT_EQ(search.search(GameState(), 10).size(), 1u + GameState::NUM_MOVES);
+    }
+
+    TEST(RootParallelSearchTest, TreesReuseTheirOwnPools)
+    {
+        RootParallelSearch search(3, uniformEvaluatorFactory(), 7);
+        auto position = std::make_unique<GameState>();
+        search.search(*position, 300);
+
+        std::vector<size_t> created;
+        for (int k = 0; k < search.getNumTrees(); ++k)
+        {
+            const NodePool &pool = search.getNodePool(k);
+            EXPECT_GT(pool.getCreatedNodes(), 0u);
+            // The tree was released back into its own pool.
+            EXPECT_EQ(pool.getLiveNodes(), 0u);
+            EXPECT_EQ(pool.getFreeNodes(), pool.getCreatedNodes());
+            created.push_back(pool.getCreatedNodes());
+        }
+
+        // A tree of the same size mostly reuses the released nodes.
+        search.search(*position, 300);
+        for (int k = 0; k < search.getNumTrees(); ++k)
+        {
+            EXPECT_LT(search.getNodePool(k).getCreatedNodes(), created[k] * 3 / 2);
+        }
+    }
+
+    TEST(RootParallelSearchTest, PinnedThreadsSearchTheSameTrees)
+    {
+        RootParallelSearch pinned(2, uniformEvaluatorFactory(), 7);
+        pinned.setThreadPinning(true);
+        RootParallelSearch unpinned(2, uniformEvaluatorFactory(), 7);
+        unpinned.setNodePools(false);
+
+        EXPECT_EQ(pinned.search(*shortestGamePosition(), 200), unpinned.search(*shortestGamePosition(), 200));
+        EXPECT_EQ(unpinned.getNodePool(0).getCreatedNodes(), 0u);
+    }
+
+    TEST(RootParallelSearchTest, SameSeedGivesTheSameMove)
+    {
+        auto position = std::make_unique<GameState>();
+        RootParallelSearch first(4, uniformEvaluatorFactory(), 42);
+        RootParallelSearch second(4, uniformEvaluatorFactory(), 42);
+        RootParallelSearch other(4, uniformEvaluatorFactory(), 43);
+
+        const std::vector<float> encoded = first.search(*position, 300);
+        EXPECT_EQ(second.search(*position, 300), encoded);
+        EXPECT_NE(other.search(*position, 300), encoded);
+
+        // The streams continue across searches until they are reseeded.
+        EXPECT_NE(first.search(*position, 300), encoded);
+        first.reseed(42);
+        EXPECT_EQ(first.search(*position, 300), encoded);
+        EXPECT_EQ(selectMove(first.search(*position, 300)), selectMove(second.search(*position, 300)));
+    }
+
+} // namespace scout
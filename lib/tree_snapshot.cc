@@ -0,0 +1,271 @@
+#include "lib/tree_snapshot.h"
+
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace scout
+{
+
+    namespace
+    {
+        static_assert(std::is_trivially_copyable_v<SnapshotNode>);
+        static_assert(sizeof(SnapshotNode) == 128, "The record layout is part of the file format.");
+
+        constexpr char MAGIC[8] = {'S', 'C', 'O', 'U', 'T', 'T', 'R', 'E'};
+        constexpr std::uint32_t VERSION = 1;
+
+        struct Header
+        {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t recordSize;
+        };
+
+        struct Footer
+        {
+            std::uint64_t records;
+            char magic[8];
+        };
+
+        SnapshotNode toRecord(const TreeNode &node, const std::array<std::uint32_t, GameState::NUM_MOVES> &children)
+        {
+            SnapshotNode record{};
+            const GameState &state = node.state();
+            for (int move = 0; move < GameState::NUM_MOVES; ++move)
+            {
+                record.priors[move] = node.evaluation().getPrior(move);
+                record.children[move] = children[move];
+            }
+            record.value = node.evaluation().getValue();
+            const AverageValue &average = node.getAverageValue();
+            record.playerOneTotal = average.getPlayerOneTotal();
+            record.support = average.getSupport();
+            record.winsOne = node.getOutcomes().getCount(Player::ONE);
+            record.winsTwo = node.getOutcomes().getCount(Player::TWO);
+            record.ties = node.getOutcomes().getCount(Player::NONE);
+            record.scoreOne = static_cast<std::int16_t>(state.getScoreOne());
+            record.scoreTwo = static_cast<std::int16_t>(state.getScoreTwo());
+            record.specialOne = static_cast<std::int8_t>(state.getSpecialOne());
+            record.specialTwo = static_cast<std::int8_t>(state.getSpecialTwo());
+            const std::vector<int> cells = state.getCells();
+            for (size_t cell = 0; cell < cells.size(); ++cell)
+            {
+                record.cells[cell] = static_cast<std::uint8_t>(cells[cell]);
+            }
+            record.player = static_cast<std::uint8_t>(state.getCurrentPlayer());
+            if (node.isInitialized())
+            {
+                record.flags |= SnapshotNode::INITIALIZED;
+            }
+            if (node.isProven())
+            {
+                record.flags |= SnapshotNode::PROVEN;
+                record.provenWinner = static_cast<std::uint8_t>(*node.getProvenWinner());
+            }
+            return record;
+        }
+
+        void check(const std::ostream &out)
+        {
+            if (!out)
+            {
+                throw std::runtime_error("Failed to write the snapshot.");
+            }
+        }
+    }
+
+    GameState SnapshotNode::state() const
+    {
+        std::array<int, 18> board;
+        for (size_t cell = 0; cell < board.size(); ++cell)
+        {
+            board[cell] = cells[cell];
+        }
+        return GameState(static_cast<Player>(player), scoreOne, scoreTwo, specialOne, specialTwo, board);
+    }
+
+    void writeSnapshot(const TreeNode &root, std::ostream &out)
+    {
+        Header header{};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.recordSize = sizeof(SnapshotNode);
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+        // Post-order without recursion: a node is written once all of its children are.
+        // Nodes with several owners, i.e. shared through a transposition table, remember
+        // their record, so the other parents refer to it instead of writing it again.
+        std::unordered_map<const TreeNode *, std::uint32_t> shared_records;
+        struct Frame
+        {
+            const TreeNode *node;
+            int nextMove;
+            std::array<std::uint32_t, GameState::NUM_MOVES> children;
+        };
+        std::vector<Frame> stack;
+        stack.push_back({&root, 0, {}});
+        stack.back().children.fill(SnapshotNode::NO_CHILD);
+        std::uint64_t written = 0;
+        while (!stack.empty())
+        {
+            Frame &frame = stack.back();
+            const auto &children = frame.node->getChildStates();
+            while (frame.nextMove < GameState::NUM_MOVES && children[frame.nextMove] == nullptr)
+            {
+                ++frame.nextMove;
+            }
+            if (frame.nextMove < GameState::NUM_MOVES)
+            {
+                const TreeNode *child = children[frame.nextMove].get();
+                if (children[frame.nextMove].use_count() > 1)
+                {
+                    const auto it = shared_records.find(child);
+                    if (it != shared_records.end())
+                    {
+                        frame.children[frame.nextMove] = it->second;
+                        ++frame.nextMove;
+                        continue;
+                    }
+                }
+                stack.push_back({child, 0, {}});
+                stack.back().children.fill(SnapshotNode::NO_CHILD);
+                continue;
+            }
+
+            const SnapshotNode record = toRecord(*frame.node, frame.children);
+            out.write(reinterpret_cast<const char *>(&record), sizeof(record));
+            stack.pop_back();
+            if (!stack.empty())
+            {
+                Frame &parent = stack.back();
+                const auto &child = parent.node->getChildStates()[parent.nextMove];
+                if (child.use_count() > 1)
+                {
+                    shared_records.emplace(child.get(), static_cast<std::uint32_t>(written));
+                }
+                parent.children[parent.nextMove] = static_cast<std::uint32_t>(written);
+                ++parent.nextMove;
+            }
+            ++written;
+        }
+
+        Footer footer{};
+        footer.records = written;
+        std::memcpy(footer.magic, MAGIC, sizeof(MAGIC));
+        out.write(reinterpret_cast<const char *>(&footer), sizeof(footer));
+        check(out);
+    }
+
+    void writeSnapshot(const TreeNode &root, const std::string &path)
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        check(out);
+        writeSnapshot(root, out);
+        out.close();
+        check(out);
+    }
+
+    TreeSnapshot::TreeSnapshot(const std::string &path)
+    {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            throw std::runtime_error("Cannot open snapshot " + path);
+        }
+        struct stat info;
+        if (::fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(Header) + sizeof(Footer)))
+        {
+            ::close(fd);
+            throw std::runtime_error("Not a snapshot: " + path);
+        }
+        mapping_size_ = static_cast<size_t>(info.st_size);
+        void *mapping = ::mmap(nullptr, mapping_size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED)
+        {
+            throw std::runtime_error("Cannot map snapshot " + path);
+        }
+        mapping_ = mapping;
+
+        const auto *bytes = static_cast<const char *>(mapping_);
+        Header header;
+        Footer footer;
+        std::memcpy(&header, bytes, sizeof(header));
+        std::memcpy(&footer, bytes + mapping_size_ - sizeof(footer), sizeof(footer));
+        const size_t records_bytes = mapping_size_ - sizeof(Header) - sizeof(Footer);
+        if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || std::memcmp(footer.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+            header.version != VERSION || header.recordSize != sizeof(SnapshotNode) ||
+            footer.records == 0 || records_bytes != footer.records * sizeof(SnapshotNode))
+        {
+            ::munmap(mapping_, mapping_size_);
+            throw std::runtime_error("Not a valid snapshot: " + path);
+        }
+        // The header keeps the records 16-byte aligned within the page-aligned mapping.
+        records_ = reinterpret_cast<const SnapshotNode *>(bytes + sizeof(Header));
+        size_ = static_cast<size_t>(footer.records);
+    }
+
+    TreeSnapshot::~TreeSnapshot()
+    {
+        ::munmap(mapping_, mapping_size_);
+    }
+
+    std::shared_ptr<TreeNode> TreeSnapshot::restore(NodePool *pool) const
+    {
+        // Children come before their parents, so one forward pass links every node.
+        std::vector<std::shared_ptr<TreeNode>> nodes(size_);
+        // Records already linked to a parent; further parents share them.
+        std::vector<bool> linked(size_, false);
+        for (size_t index = 0; index < size_; ++index)
+        {
+            const SnapshotNode &record = records_[index];
+            const GameState state = record.state();
+            std::shared_ptr<TreeNode> node = pool != nullptr
+                                                 ? pool->acquire(state)
+                                                 : std::make_shared<TreeNode>(std::make_unique<GameState>(state),
+                                                                              GameState::NUM_MOVES);
+
+            node->_evaluation.setValue(record.value);
+            std::vector<float> &policy = node->_evaluation.getPolicy();
+            std::copy(record.priors, record.priors + GameState::NUM_MOVES, policy.begin());
+            node->_averageValue = AverageValue(record.playerOneTotal, record.support);
+            node->_outcomes = Outcomes(record.winsOne, record.winsTwo, record.ties);
+            node->_initialized = (record.flags & SnapshotNode::INITIALIZED) != 0;
+            if (record.flags & SnapshotNode::PROVEN)
+            {
+                node->_provenWinner = static_cast<Player>(record.provenWinner);
+            }
+            for (int move = 0; move < GameState::NUM_MOVES; ++move)
+            {
+                const std::uint32_t child = record.children[move];
+                if (child != SnapshotNode::NO_CHILD)
+                {
+                    if (child >= index)
+                    {
+                        throw std::runtime_error("Corrupt snapshot: bad child index.");
+                    }
+                    node->_childStates[move] = nodes[child];
+                    if (linked[child])
+                    {
+                        // As for a child taken from a transposition table.
+                        node->_sharedChildren |= 1u << move;
+                    }
+                    linked[child] = true;
+                }
+            }
+            nodes[index] = std::move(node);
+        }
+        return std::move(nodes.back());
+    }
+
+} // namespace scout
@@ -0,0 +1,106 @@
+#ifndef WASM_SCOUT_LIB_TREE_SNAPSHOT_H
+#define WASM_SCOUT_LIB_TREE_SNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+
+#include "lib/game.h"
+#include "lib/mcts.h"
+
+namespace scout
+{
+
+    /**
+     * @brief One node of a snapshot, in the file's own fixed layout (little-endian, as on
+     * x86, ARM and WebAssembly).
+     *
+     * Records are written in post-order, children before their parent, so a parent can
+     * refer to its children by record index and the root is the last record. Several
+     * parents refer to the same record for a node shared through a transposition table.
+     */
+    struct SnapshotNode
+    {
+        static constexpr std::uint32_t NO_CHILD = 0xffffffffu;
+
+        // Flag bits.
+        static constexpr std::uint8_t INITIALIZED = 1;
+        static constexpr std::uint8_t PROVEN = 2;
+
+        float priors[GameState::NUM_MOVES];
+        // Record index of the child for each move, or NO_CHILD.
+        std::uint32_t children[GameState::NUM_MOVES];
+        // The network's value of the state, for the player to move.
+        float value;
+        // The AverageValue: sum from Player ONE's perspective, and its support.
+        float playerOneTotal;
+        std::int32_t support;
+        // The Outcomes: wins of Player ONE and TWO, and ties.
+        std::int32_t winsOne;
+        std::int32_t winsTwo;
+        std::int32_t ties;
+        std::int16_t scoreOne;
+        std::int16_t scoreTwo;
+        std::int8_t specialOne;
+        std::int8_t specialTwo;
+        std::uint8_t cells[18];
+        // Player of the state, and for proven nodes the proven winner (NONE: a draw).
+        std::uint8_t player;
+        std::uint8_t provenWinner;
+        std::uint8_t flags;
+        std::uint8_t reserved[5];
+
+        GameState state() const;
+        int getVisits() const { return winsOne + winsTwo + ties; }
+    };
+
+    /**
+     * @brief Writes the tree below `root` in one streaming pass: a header, one record per
+     * node in post-order, and a footer with the record count. A node shared through a
+     * transposition table is written once, and every parent refers to that record.
+     * Throws std::runtime_error if the stream fails.
+     */
+    void writeSnapshot(const TreeNode &root, std::ostream &out);
+    void writeSnapshot(const TreeNode &root, const std::string &path);
+
+    /**
+     * @brief A read-only snapshot mapped into memory with mmap.
+     *
+     * Opening only maps and validates the file, so even a snapshot of millions of nodes
+     * can be inspected at once: records are read straight from the mapping, and pages
+     * are loaded on first access. restore() rebuilds TreeNodes to resume the search.
+     */
+    class TreeSnapshot
+    {
+    public:
+        // Maps `path`; throws std::runtime_error if it can't, or if it isn't a valid snapshot.
+        explicit TreeSnapshot(const std::string &path);
+        TreeSnapshot(const TreeSnapshot &) = delete;
+        TreeSnapshot &operator=(const TreeSnapshot &) = delete;
+        ~TreeSnapshot();
+
+        size_t size() const { return size_; }
+        const SnapshotNode &getNode(std::uint32_t index) const { return records_[index]; }
+        const SnapshotNode &getRoot() const { return records_[size_ - 1]; }
+
+        /**
+         * @brief Rebuilds the tree with its priors, values, visits, proofs and children.
+         * A record referred to by several parents becomes one node that they share, as
+         * it was when written. The transposition table itself isn't saved, so a resumed
+         * search only shares the nodes it creates itself.
+         * @param pool If set, the nodes are taken from the pool.
+         */
+        std::shared_ptr<TreeNode> restore(NodePool *pool = nullptr) const;
+
+    private:
+        void *mapping_ = nullptr;
+        size_t mapping_size_ = 0;
+        const SnapshotNode *records_ = nullptr;
+        size_t size_ = 0;
+    };
+
+} // namespace scout
+
+#endif // WASM_SCOUT_LIB_TREE_SNAPSHOT_H
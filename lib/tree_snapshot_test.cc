@@ -0,0 +1,207 @@
+#include "lib/tree_snapshot.h"
+
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace scout
+{
+
+    namespace
+    {
+        std::unique_ptr<GameState> middlegamePosition()
+        {
+            auto state = std::make_unique<GameState>();
+            return state->move(8)->move(1)->move(7)->move(3);
+        }
+
+        std::string snapshotPath(const std::string &name)
+        {
+            return ::testing::TempDir() + name + ".snapshot";
+        }
+
+        // Fails the test unless both trees have the same shape, states and statistics.
+        void expectSameTree(const TreeNode &expected, const TreeNode &actual)
+        {
+            ASSERT_EQ(expected.state(), actual.state());
+            EXPECT_EQ(expected.getVisits(), actual.getVisits());
+            EXPECT_EQ(expected.getOutcomes(), actual.getOutcomes());
+            EXPECT_EQ(expected.isInitialized(), actual.isInitialized());
+            EXPECT_EQ(expected.getProvenWinner(), actual.getProvenWinner());
+            EXPECT_EQ(expected.evaluation().getValue(), actual.evaluation().getValue());
+            EXPECT_EQ(expected.evaluation().getPolicy(), actual.evaluation().getPolicy());
+            EXPECT_EQ(expected.getAverageValue().getSupport(),
+                      actual.getAverageValue().getSupport());
+            EXPECT_EQ(expected.getAverageValue().getPlayerOneTotal(),
+                      actual.getAverageValue().getPlayerOneTotal());
+            for (int move = 0; move < GameState::NUM_MOVES; ++move)
+            {
+                const auto &expected_child = expected.getChildStates()[move];
+                const auto &actual_child = actual.getChildStates()[move];
+                ASSERT_EQ(expected_child == nullptr, actual_child == nullptr) << "move " << move;
+                if (expected_child != nullptr)
+                {
+                    expectSameTree(*expected_child, *actual_child);
+                }
+            }
+        }
+    }
+
+    TEST(TreeSnapshotTest, RoundTripRestoresTheTree)
+    {
+        PredictiveUpperConfidenceBound pucb_strategy(1);
+        MonteCarloTreeSearch mcts(std::ref(pucb_strategy), ZeroValueUniformEvaluator(GameState::NUM_MOVES));
+        TreeNode root(middlegamePosition(), GameState::NUM_MOVES);
+        for (int i = 0; i < 3000; ++i)
+        {
+            mcts.expand(&root);
+        }
+
+        const std::string path = snapshotPath("round_trip");
+        writeSnapshot(root, path);
+        TreeSnapshot snapshot(path);
+
+        EXPECT_EQ(snapshot.size(), countNodes(root));
+        // Records can be read straight from the mapping.
+        EXPECT_EQ(snapshot.getRoot().getVisits(), root.getVisits());
+        EXPECT_EQ(snapshot.getRoot().state(), root.state());
+        const std::uint32_t best = snapshot.getRoot().children[root.getBestMove()];
+        ASSERT_NE(best, SnapshotNode::NO_CHILD);
+        EXPECT_EQ(snapshot.getNode(best).getVisits(), root.getChildStates()[root.getBestMove()]->getVisits());
+
+        std::shared_ptr<TreeNode> restored = snapshot.restore();
+        expectSameTree(root, *restored);
+        EXPECT_EQ(restored->encode(), root.encode());
+        EXPECT_EQ(restored->getBestMove(), root.getBestMove());
+        std::remove(path.c_str());
+    }
+
+    TEST(TreeSnapshotTest, ProofsSurviveTheRoundTrip)
+    {
+        // Move 8 wins at once, so the search proves the root.
+        std::unique_ptr<GameState> state = middlegamePosition();
+        for (int move : {6, 3, 4, 1, 8, 8})
+        {
+            state = state->move(move);
+        }
+        PredictiveUpperConfidenceBound pucb_strategy(1);
+        MonteCarloTreeSearch mcts(std::ref(pucb_strategy), ZeroValueUniformEvaluator(GameState::NUM_MOVES));
+        TreeNode root(std::move(state), GameState::NUM_MOVES);
+        for (int i = 0; i < 200; ++i)
+        {
+            mcts.expand(&root);
+        }
+        ASSERT_TRUE(root.isProven());
+
+        std::stringstream buffer;
+        writeSnapshot(root, buffer);
+        const std::string path = snapshotPath("proofs");
+        std::ofstream(path, std::ios::binary) << buffer.rdbuf();
+
+        TreeSnapshot snapshot(path);
+        EXPECT_TRUE(snapshot.getRoot().flags & SnapshotNode::PROVEN);
+        std::shared_ptr<TreeNode> restored = snapshot.restore();
+        ASSERT_TRUE(restored->isProven());
+        EXPECT_EQ(restored->getProvenWinner(), root.getProvenWinner());
+        expectSameTree(root, *restored);
+        std::remove(path.c_str());
+    }
+
+    TEST(TreeSnapshotTest, RestoredTreeResumesTheSearch)
+    {
+        PredictiveUpperConfidenceBound pucb_strategy(1);
+        MonteCarloTreeSearch mcts(std::ref(pucb_strategy), ZeroValueUniformEvaluator(GameState::NUM_MOVES));
+        TreeNode root(middlegamePosition(), GameState::NUM_MOVES);
+        for (int i = 0; i < 500; ++i)
+        {
+            mcts.expand(&root);
+        }
+        const std::string path = snapshotPath("resume");
+        writeSnapshot(root, path);
+
+        NodePool pool;
+        mcts.setNodePool(&pool);
+        std::shared_ptr<TreeNode> restored = TreeSnapshot(path).restore(&pool);
+        EXPECT_EQ(pool.getLiveNodes(), countNodes(root));
+        for (int i = 0; i < 500; ++i)
+        {
+            mcts.expand(restored.get());
+        }
+        EXPECT_EQ(restored->getVisits(), 1000);
+        std::remove(path.c_str());
+    }
+
+    TEST(TreeSnapshotTest, SharedNodesAreWrittenOnce)
+    {
+        PredictiveUpperConfidenceBound pucb_strategy(1);
+        MonteCarloTreeSearch mcts(std::ref(pucb_strategy), ZeroValueUniformEvaluator(GameState::NUM_MOVES));
+        TranspositionTable transpositions;
+        mcts.setTranspositionTable(&transpositions);
+        TreeNode root(middlegamePosition(), GameState::NUM_MOVES);
+        for (int i = 0; i < 3000; ++i)
+        {
+            mcts.expand(&root);
+        }
+        ASSERT_GT(transpositions.getHits(), 0u);
+
+        const std::string path = snapshotPath("shared");
+        writeSnapshot(root, path);
+        TreeSnapshot snapshot(path);
+        // countNodes() counts a shared node once per parent; the snapshot holds it once.
+        EXPECT_LT(snapshot.size(), countNodes(root));
+
+        std::shared_ptr<TreeNode> restored = snapshot.restore();
+        expectSameTree(root, *restored);
+
+        // The restored graph has one node per record, shared by the same parents.
+        std::unordered_set<const TreeNode *> distinct;
+        std::vector<const TreeNode *> stack = {restored.get()};
+        while (!stack.empty())
+        {
+            const TreeNode *node = stack.back();
+            stack.pop_back();
+            if (!distinct.insert(node).second)
+            {
+                continue;
+            }
+            for (const auto &child : node->getChildStates())
+            {
+                if (child != nullptr)
+                {
+                    stack.push_back(child.get());
+                }
+            }
+        }
+        EXPECT_EQ(distinct.size(), snapshot.size());
+        std::remove(path.c_str());
+    }
+
+    TEST(TreeSnapshotTest, RejectsInvalidFiles)
+    {
+        EXPECT_THROW(TreeSnapshot(snapshotPath("missing")), std::runtime_error);
+
+        TreeNode root(middlegamePosition(), GameState::NUM_MOVES);
+        std::stringstream buffer;
+        writeSnapshot(root, buffer);
+        const std::string bytes = buffer.str();
+
+        const std::string path = snapshotPath("invalid");
+        // Truncated.
+        std::ofstream(path, std::ios::binary) << bytes.substr(0, bytes.size() - 1);
+        EXPECT_THROW(TreeSnapshot{path}, std::runtime_error);
+        // Wrong magic.
+        std::ofstream(path, std::ios::binary) << "X" + bytes.substr(1);
+        EXPECT_THROW(TreeSnapshot{path}, std::runtime_error);
+        // Intact.
+        std::ofstream(path, std::ios::binary) << bytes;
+        EXPECT_EQ(TreeSnapshot(path).size(), 1u);
+        std::remove(path.c_str());
+    }
+
+} // namespace scout
@@ -1,12 +1,16 @@
 #include "lib/wasm.h"
 #include <string>
 
+#include "lib/anytime_search.h"
 #include "lib/game.h"
+#include "lib/gumbel_search.h"
 #include "lib/mcts.h"
+#include "lib/pondering_search.h"
 #include <iostream>
 #include <string>
 #include <chrono>
 #include <limits>
+#include <random>
 #include <sstream>
 
 #ifdef __EMSCRIPTEN__
@@ -18,59 +22,200 @@ using namespace emscripten;
 namespace scout
 {
 
-    int infer(const GameState &game_state)
+    namespace
     {
-        OnnxEvaluator onnx_evaluator;
-        PredictiveUpperConfidenceBound pucb_strategy;
-        MonteCarloTreeSearch mcts(std::ref(pucb_strategy), std::ref(onnx_evaluator));
+        // What the engine's tree may occupy while it ponders.
+        constexpr size_t TREE_BYTE_BUDGET = size_t{128} << 20;
+
+        SearchStats last_search_stats;
+
+        // The engine's search, kept between calls so that pondering and infer() share one tree.
+        struct Engine
+        {
+            OnnxEvaluator onnx_evaluator;
+            PredictiveUpperConfidenceBound pucb_strategy;
+            PonderingSearch search{std::ref(pucb_strategy), std::ref(onnx_evaluator)};
+            // Seeds of the one-off searches, such as inferGumbel()'s.
+            Xoshiro128 seeds{std::random_device{}()};
+
+            Engine() { search.setByteBudget(TREE_BYTE_BUDGET); }
+        };
+
+        Engine &engine()
+        {
+            static Engine instance;
+            return instance;
+        }
+
+        SearchLimits inferLimits(int latency_target_ms)
+        {
+            SearchLimits limits;
+            limits.deadline = std::chrono::milliseconds(latency_target_ms);
+            // A simulation with the ONNX model takes well under a millisecond.
+            limits.checkInterval = 8;
+            // Stop early once the move can't change any more, and, given a simulation
+            // budget, stop searching moves that can't become the most visited one.
+            limits.stopWhenDecided = true;
+            limits.pruneUnreachable = true;
+            return limits;
+        }
+
+        // Searches `game_state` within `limits` for infer(), and returns the move to play.
+        int playMove(const GameState &game_state, const SearchLimits &limits)
+        {
+            std::cout << game_state.toString();
+
+            SearchResult result = engine().search.search(game_state, limits);
+            last_search_stats = result.stats;
+
+            std::cout << "\nReused " << engine().search.getReusedVisits() << " visits. "
+                      << result.stats.toString() << std::endl;
+
+            const auto &encoded = result.rootStatistics;
+            std::cout << "Encoded: [";
+            for (size_t i = 0; i < encoded.size(); ++i)
+            {
+                std::cout << encoded[i] << ",";
+            }
+            std::cout << "] ";
 
-        auto root_state = std::make_unique<GameState>(game_state);
+            return result.bestMove;
+        }
+    }
 
-        std::cout << root_state->toString();
+    const SearchStats &getLastSearchStats()
+    {
+        return last_search_stats;
+    }
 
-        auto root_node = std::make_unique<TreeNode>(std::move(root_state), GameState::NUM_MOVES);
+    int infer(const GameState &game_state, int latency_target_ms)
+    {
+        return playMove(game_state, inferLimits(latency_target_ms));
+    }
 
-        const int num_expansions = 2000;
+    int infer(const GameState &game_state, int latency_target_ms, int max_simulations)
+    {
+        SearchLimits limits = inferLimits(latency_target_ms);
+        limits.maxSimulations = max_simulations;
+        return playMove(game_state, limits);
+    }
 
-        auto start = std::chrono::steady_clock::now();
+    std::vector<MoveAnalysis> analyze(const GameState &game_state, int latency_target_ms, int lines)
+    {
+        SearchLimits limits;
+        limits.deadline = std::chrono::milliseconds(latency_target_ms);
+        limits.checkInterval = 8;
+        // Unlike infer(), spend the whole budget: the other moves' lines are part of the answer.
+        SearchResult result = engine().search.search(game_state, limits);
+        last_search_stats = result.stats;
+        return analyzeRoot(*engine().search.getRoot(), lines);
+    }
 
-        for (int i = 0; i < num_expansions; ++i)
+    int ponder(const GameState &game_state, int slice_ms)
+    {
+        if (game_state.isGameOver())
         {
-            mcts.expand(root_node.get());
+            return 0;
         }
+        SearchLimits limits;
+        limits.deadline = std::chrono::milliseconds(slice_ms);
+        limits.checkInterval = 8;
+        return engine().search.search(game_state, limits).simulations;
+    }
+
+    void setSeed(std::uint32_t seed)
+    {
+        Engine &instance = engine();
+        instance.search.clear();
+        instance.pucb_strategy.reseed(seed);
+        instance.seeds = Xoshiro128(seed);
+    }
+
+    int inferGumbel(const GameState &game_state, int simulations)
+    {
+        OnnxEvaluator onnx_evaluator;
+        const std::uint32_t seed = engine().seeds();
+        PredictiveUpperConfidenceBound pucb_strategy(seed);
+        GumbelSearch search(std::ref(pucb_strategy), std::ref(onnx_evaluator), seed);
 
-        auto end = std::chrono::steady_clock::now();
+        SearchResult result = search.search(game_state, simulations);
+        last_search_stats = result.stats;
 
-        auto duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+        std::cout << "\nGumbel search: " << result.stats.toString() << std::endl;
 
-        std::cout << "\nExecution took: " << duration_ms.count() << " milliseconds" << std::endl;
+        return result.bestMove;
+    }
+}
 
-        auto encoded = root_node->encode();
-        std::cout << "Encoded: [";
-        for (size_t i = 0; i < encoded.size(); ++i)
+#ifdef __EMSCRIPTEN__
+namespace
+{
+    // The last search's statistics as a plain object, with times in milliseconds.
+    val lastSearchStats()
+    {
+        using Milliseconds = std::chrono::duration<double, std::milli>;
+        const scout::SearchStats &stats = scout::getLastSearchStats();
+        val batch_sizes = val::array();
+        for (std::uint64_t count : stats.batchSizes)
         {
-            std::cout << encoded[i] << ",";
+            batch_sizes.call<void>("push", static_cast<double>(count));
         }
-        std::cout << "] ";
 
-        int best_move = 0;
-        float best_value = 0;
-        for (size_t i = 1; i < encoded.size(); ++i)
+        val result = val::object();
+        result.set("simulations", static_cast<double>(stats.simulations));
+        result.set("evaluatorCalls", static_cast<double>(stats.evaluatorCalls));
+        result.set("evaluatedRows", static_cast<double>(stats.evaluatedRows));
+        result.set("batchSizes", batch_sizes);
+        result.set("terminalHits", static_cast<double>(stats.terminalHits));
+        result.set("deferredExpansions", static_cast<double>(stats.deferredExpansions));
+        result.set("maxDepth", stats.maxDepth);
+        result.set("averageDepth", stats.averageDepth());
+        result.set("nodes", static_cast<double>(stats.nodes));
+        result.set("bytes", static_cast<double>(stats.bytes));
+        result.set("simulationsPerSecond", stats.simulationsPerSecond());
+        result.set("selectionMs", Milliseconds(stats.selectionTime).count());
+        result.set("expansionMs", Milliseconds(stats.expansionTime).count());
+        result.set("evaluationMs", Milliseconds(stats.evaluationTime).count());
+        result.set("backpropagationMs", Milliseconds(stats.backpropagationTime).count());
+        result.set("elapsedMs", Milliseconds(stats.elapsed).count());
+        return result;
+    }
+}
+
+namespace
+{
+    // analyze() as an array of plain objects, best move first; provenWinner is null
+    // unless the move is proven.
+    val analyzePosition(const scout::GameState &game_state, int latency_target_ms, int lines)
+    {
+        val result = val::array();
+        for (const scout::MoveAnalysis &line : scout::analyze(game_state, latency_target_ms, lines))
         {
-            if (best_value < encoded[i])
+            val principal_variation = val::array();
+            for (int move : line.principalVariation)
             {
-                best_move = i;
-                best_value = encoded[i];
+                principal_variation.call<void>("push", move);
             }
+            val entry = val::object();
+            entry.set("move", line.move);
+            entry.set("visits", line.visits);
+            entry.set("value", line.value);
+            entry.set("prior", line.prior);
+            entry.set("provenWinner", line.provenWinner.has_value() ? val(*line.provenWinner) : val::null());
+            entry.set("principalVariation", principal_variation);
+            result.call<void>("push", entry);
         }
-
-        return best_move - 1;
+        return result;
     }
 }
 
-#ifdef __EMSCRIPTEN__
 EMSCRIPTEN_BINDINGS(my_module)
 {
-    function("infer", &scout::infer);
+    function("infer", select_overload<int(const scout::GameState &, int)>(&scout::infer));
+    function("inferGumbel", &scout::inferGumbel);
+    function("ponder", &scout::ponder);
+    function("setSeed", &scout::setSeed);
+    function("analyze", &analyzePosition);
+    function("lastSearchStats", &lastSearchStats);
 }
 #endif
\ No newline at end of file
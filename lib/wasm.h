@@ -2,12 +2,44 @@
 #define LIB_WASM_H
 
 
+#include <cstdint>
+#include <vector>
+
 #include "lib/game.h"
+#include "lib/mcts.h"
 
 namespace scout
 {
 
-    int infer(const GameState &game_state);
+    // Searches `game_state` for about `latency_target_ms` milliseconds, or until the
+    // position is solved, and returns the move to play. The search continues the tree of
+    // earlier infer() and ponder() calls if it contains the position.
+    int infer(const GameState &game_state, int latency_target_ms);
+
+    // Like infer(), but also stops after `max_simulations` simulations. After setSeed(),
+    // the move then only depends on the machine's speed if the deadline comes first.
+    int infer(const GameState &game_state, int latency_target_ms, int max_simulations);
+
+    // Searches `game_state` like infer() and reports its `lines` best moves, best first,
+    // with their visits, values, priors, proofs and principal variations.
+    std::vector<MoveAnalysis> analyze(const GameState &game_state, int latency_target_ms, int lines);
+
+    // Grows the engine's tree of `game_state`, usually the position the opponent has to
+    // move in, for about `slice_ms` milliseconds; returns the simulations run. The next
+    // infer() of a position reached from it continues that tree.
+    int ponder(const GameState &game_state, int slice_ms);
+
+    // Restarts the engine's random streams from `seed` and releases its tree. Searches
+    // with a fixed number of simulations, such as inferGumbel(), then repeat exactly;
+    // infer() still depends on how many simulations fit in its time.
+    void setSeed(std::uint32_t seed);
+
+    // Searches `game_state` with a fixed, small number of simulations using Gumbel
+    // sequential halving at the root, and returns the move to play.
+    int inferGumbel(const GameState &game_state, int simulations);
+
+    // The statistics of the last infer() or inferGumbel() call.
+    const SearchStats &getLastSearchStats();
 
 }
 
@@ -11,6 +11,6 @@ int main(int argc, char **argv)
   auto root_state = std::make_unique<scout::GameState>();
   root_state = root_state->move(8)->move(1)->move(7)->move(3)->move(6)->move(3)->move(4)->move(1)->move(8)->move(8);
 
-  infer(*root_state);
+  infer(*root_state, 1000);
   return 0;
 }
\ No newline at end of file
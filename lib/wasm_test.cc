@@ -10,7 +10,12 @@ namespace scout
         auto root_state = std::make_unique<GameState>();
         //root_state = root_state->move(8)->move(1)->move(7)->move(3)->move(6)->move(3)->move(4)->move(1)->move(8)->move(8);
 
-        EXPECT_EQ(infer(*root_state.get()), 8);
+        // A fixed seed and simulation budget, with a deadline no machine should reach, so
+        // the move doesn't depend on the machine's speed.
+        setSeed(1);
+        EXPECT_EQ(infer(*root_state.get(), 60000, 2000), 8);
+        EXPECT_LE(getLastSearchStats().simulations, 2000u);
+        EXPECT_GT(getLastSearchStats().simulations, 0u);
     }
 
 }
\ No newline at end of file